@@ -10,29 +10,364 @@
 
 #include <imageplus/core/signal.hpp>
 #include <imageplus/core/colorspaces.hpp>
+#include <boost/type_traits/is_floating_point.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace imageplus {
 
+	//! Converts 3-channel signals (stored B,G,R like OpenCV) between RGB, YUV and LAB.
+	//!
+	//! convert(Signal&, ColorSpaceType) chooses the conversion once per signal and converts the raw interleaved
+	//! values row by row, keeping the intermediate results in float64. The powers of the sRGB gamma and the
+	//! cube root of LAB are read from tables (exact for integer values in [0,255], linearly interpolated otherwise),
+	//! so no pow() is called for values in range.
+	//!
+	//! When SSE2 is available (__SSE2__, always on x86-64) and the values of the signal are floating point,
+	//! RGB -> LAB is converted in batches of 4 units with SIMD instructions in float32: the channels of a batch are
+	//! deinterleaved and linearised (with a float32 table for 8-bit input), and the XYZ products and the cube root
+	//! (Newton iterations from an exponent estimate) are computed on the 4 units at once. The other conversions, and
+	//! the ones to integer values, use the scalar float64 kernels; the RGB <-> YUV ones are only products and
+	//! clipping, which the compiler already vectorises, so batching them was slower.
+	//!
+	//! The results differ from the per-value functions (convert(const value_type&, ...)) by less than 1e-3 for
+	//! RGB <-> LAB and are equal for RGB <-> YUV, except that integer signals are no longer truncated to integers in
+	//! the intermediate steps (e.g. XYZ).
 	template<class Signal>
 	class ColorSpaceConverter {
 
-		typedef typename Signal::value_type		value_type;
+		typedef typename Signal::value_type			value_type;
+		typedef typename Signal::value_data_type	value_data_type;
 
 	public:
 
+		//! Constructor, fills the tables
+		ColorSpaceConverter() {
+			for (uint64 i = 0; i < 256; i++) {
+				float64 l = i/255.0;
+				_srgb_to_linear[i] = (l < 0.03928) ? l / 12.92 : pow((l+0.055)/(1.055),2.4);
+				_srgb_to_linear_f[i] = (float32)_srgb_to_linear[i];
+			}
+			_gamma.init(2.4, 1.0);
+			_inverse_gamma.init(1/2.4, 1.0);
+			_cube_root.init(1.0/3.0, 1.25);
+		}
+
 		inline void convert(Signal& s, ColorSpaceType output_color_space) {
 			if (s.color_space() == output_color_space) return;
 
-
-			for (typename Signal::iterator p = s.begin(); p != s.end(); ++p) {
-				value_type v = convert(*p, s.color_space(), output_color_space);
-				*p = v;
+			typename RowFunction<value_data_type>::type f = _row_function<value_data_type>(s.color_space(), output_color_space);
+
+			typename Signal::span_iterator sp = s.span_begin();
+			typename Signal::span_iterator sp_end = s.span_end();
+			if (!Signal::layout_type::planar) {
+				for (; sp != sp_end; ++sp) {
+					(this->*f)(sp->data, sp->data, sp->length);
+				}
+			} else {
+				// the channels of every row are interleaved in a buffer, converted and copied back
+				std::vector<value_data_type> row;
+				for (; sp != sp_end; ++sp) {
+					row.resize(3*sp->length);
+					for (uint64 i = 0; i < sp->length; i++)
+						for (uint64 c = 0; c < 3; c++) row[3*i + c] = sp->data[i + c*sp->channel_stride];
+					(this->*f)(&row[0], &row[0], sp->length);
+					for (uint64 i = 0; i < sp->length; i++)
+						for (uint64 c = 0; c < 3; c++) sp->data[i + c*sp->channel_stride] = row[3*i + c];
+				}
 			}
 			s.set_color_space(output_color_space);
 		}
 
+		//! Converts rows of interleaved values of any type (e.g. decoded from a file) into the buffer of a signal,
+		//! reading and writing every value once. The conversion is chosen once for all the rows.
+		//! \param[in] src : first row of values in the input color space
+		//! \param[in] src_step : distance between the beginning of two rows of src, in values of source_type
+		//! \param[out] dst : first row of the output, with interleaved values
+		//! \param[in] dst_step : distance between the beginning of two rows of dst, in values (at least length*3)
+		//! \param[in] length : number of values (3 channels) of every row
+		//! \param[in] rows : number of rows
+		//! \param[in] input_color_space : color space of src
+		//! \param[in] output_color_space : color space of dst
+		template<typename source_type>
+		void convert(const source_type* src, uint64 src_step, value_data_type* dst, uint64 dst_step, uint64 length, uint64 rows, ColorSpaceType input_color_space, ColorSpaceType output_color_space) {
+			typename RowFunction<source_type>::type f = _row_function<source_type>(input_color_space, output_color_space);
+			for (uint64 i = 0; i < rows; i++, src += src_step, dst += dst_step) {
+				(this->*f)(src, dst, length);
+			}
+		}
+
+	protected:
+
+		//! Converts a row of interleaved values from src to dst (which can be the same buffer)
+		template<typename source_type>
+		struct RowFunction {
+			typedef void (ColorSpaceConverter::*type)(const source_type* src, value_data_type* dst, uint64 length);
+		};
+
+		//! Converts one value from three float64 to three float64
+		typedef void (ColorSpaceConverter::*value_function)(const float64* in, float64* out);
+
+		//! x^exponent for x in [0, max], interpolating linearly a table sampled uniformly in sqrt(x), where the
+		//! curvature of the roots is lower. Values out of range are computed with pow.
+		class PowerTable {
+		public:
+
+			void init(float64 exponent, float64 max, uint64 size = 4096) {
+				_exponent = exponent;
+				_max = max;
+				_scale = size / sqrt(max);
+				_values.resize(size + 2);
+				for (uint64 i = 0; i < size + 2; i++) {
+					float64 x = i / _scale;
+					_values[i] = pow(x*x, exponent);
+				}
+			}
+
+			inline float64 operator()(float64 x) const {
+				if (!(x >= 0 && x <= _max)) return pow(x, _exponent);
+				const float64 p = sqrt(x) * _scale;
+				const uint64 i = (uint64)p;
+				return _values[i] + (p - i) * (_values[i+1] - _values[i]);
+			}
+
+		protected:
+
+			float64 _exponent;
+			float64 _max;
+			float64 _scale;
+			std::vector<float64> _values;
+		};
+
+		//! Chooses the row conversion of a pair of color spaces
+		template<typename source_type>
+		typename RowFunction<source_type>::type _row_function(ColorSpaceType input, ColorSpaceType output) {
+			if (input == output) return &ColorSpaceConverter::template _copy_row<source_type>;
+#if defined(__SSE2__)
+			// batches in float32 are only written to floating point values, so integers are truncated as before
+			if (boost::is_floating_point<value_data_type>::value && input == ColorSpaceRGB && output == ColorSpaceLAB) {
+				return &ColorSpaceConverter::template _batch_row<&ColorSpaceConverter::_rgb_to_lab, &ColorSpaceConverter::_rgb_to_lab_batch, source_type>;
+			}
+#endif
+			if (input == ColorSpaceRGB) {
+				if (output == ColorSpaceYUV) return &ColorSpaceConverter::template _row<&ColorSpaceConverter::_rgb_to_yuv, source_type>;
+				if (output == ColorSpaceLAB) return &ColorSpaceConverter::template _row<&ColorSpaceConverter::_rgb_to_lab, source_type>;
+			}
+			if (input == ColorSpaceYUV) {
+				if (output == ColorSpaceRGB) return &ColorSpaceConverter::template _row<&ColorSpaceConverter::_yuv_to_rgb, source_type>;
+				if (output == ColorSpaceLAB) return &ColorSpaceConverter::template _row<&ColorSpaceConverter::_yuv_to_lab, source_type>;
+			}
+			if (input == ColorSpaceLAB) {
+				if (output == ColorSpaceRGB) return &ColorSpaceConverter::template _row<&ColorSpaceConverter::_lab_to_rgb, source_type>;
+				if (output == ColorSpaceYUV) return &ColorSpaceConverter::template _row<&ColorSpaceConverter::_lab_to_yuv, source_type>;
+			}
+			return &ColorSpaceConverter::template _zero_row<source_type>;
+		}
+
+		//! Converts a row with a value conversion. Every value is read before it is written, so src can be dst.
+		template<value_function F, typename source_type>
+		void _row(const source_type* src, value_data_type* dst, uint64 length) {
+			float64 in[3], out[3];
+			for (const source_type* end = src + 3*length; src != end; src += 3, dst += 3) {
+				in[0] = src[0]; in[1] = src[1]; in[2] = src[2];
+				(this->*F)(in, out);
+				dst[0] = static_cast<value_data_type>(out[0]);
+				dst[1] = static_cast<value_data_type>(out[1]);
+				dst[2] = static_cast<value_data_type>(out[2]);
+			}
+		}
+
+#if defined(__SSE2__)
+		//! Units converted at once by the SIMD kernels
+		static const uint64 batch_size = 4;
+
+		//! Converts a batch of units given as three planes of batch_size float32 (one per channel) of linear intensities
+		typedef void (ColorSpaceConverter::*batch_function)(const float32* in, float32* out);
+
+		//! Converts a row in batches of batch_size units with a SIMD kernel, and the last units with the scalar
+		//! conversion F. Every batch is read before it is written, so src can be dst.
+		template<value_function F, batch_function B, typename source_type>
+		void _batch_row(const source_type* src, value_data_type* dst, uint64 length) {
+			float32 in[3*batch_size], out[3*batch_size];
+			uint64 i = 0;
+			for (; i + batch_size <= length; i += batch_size, src += 3*batch_size, dst += 3*batch_size) {
+				for (uint64 k = 0; k < batch_size; k++) {
+					for (uint64 c = 0; c < 3; c++) in[c*batch_size + k] = _linear(src[3*k + c]);
+				}
+				(this->*B)(in, out);
+				for (uint64 k = 0; k < batch_size; k++) {
+					for (uint64 c = 0; c < 3; c++) dst[3*k + c] = static_cast<value_data_type>(out[c*batch_size + k]);
+				}
+			}
+			_row<F, source_type>(src, dst, length - i);
+		}
+
+		//! Linear intensity of an 8-bit sRGB value
+		inline float32 _linear(uint8 v) const {
+			return _srgb_to_linear_f[v];
+		}
+
+		//! Linear intensity of any sRGB value
+		template<typename T>
+		inline float32 _linear(T v) const {
+			return (float32)_linearize(v);
+		}
+
+		//! a*x + b*y + c*z + d
+		static inline __m128 _combine(float32 a, __m128 x, float32 b, __m128 y, float32 c, __m128 z, float32 d) {
+			return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a), x), _mm_mul_ps(_mm_set1_ps(b), y)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c), z), _mm_set1_ps(d)));
+		}
+
+		//! f() of LAB. The cube root starts from the bits of the float with the exponent divided by 3, and is
+		//! refined with three Newton iterations (y = (2y + t/y^2) / 3).
+		static inline __m128 _lab_f_batch(__m128 t) {
+			const __m128 threshold = _mm_set1_ps(0.00885645167903563f);	// (6/29)^3
+			const __m128 tc = _mm_max_ps(t, threshold);
+			const __m128 third = _mm_set1_ps(1.0f/3.0f);
+
+			__m128 y = _mm_castsi128_ps(_mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_castps_si128(tc)), third), _mm_set1_ps(709921077.0f))));
+			for (uint64 k = 0; k < 3; k++) {
+				y = _mm_mul_ps(_mm_add_ps(_mm_add_ps(y, y), _mm_div_ps(tc, _mm_mul_ps(y, y))), third);
+			}
+
+			const __m128 linear = _mm_add_ps(_mm_mul_ps(_mm_set1_ps((1.0f/3.0f)*(29.0f/6.0f)*(29.0f/6.0f)), t), _mm_set1_ps(4.0f/29.0f));
+			const __m128 above = _mm_cmpgt_ps(t, threshold);
+			return _mm_or_ps(_mm_and_ps(above, y), _mm_andnot_ps(above, linear));
+		}
+
+		void _rgb_to_lab_batch(const float32* in, float32* out) {
+			const __m128 lb = _mm_loadu_ps(in), lg = _mm_loadu_ps(in + batch_size), lr = _mm_loadu_ps(in + 2*batch_size);
+
+			const __m128 fx = _lab_f_batch(_combine(0.412453f/0.95046866f, lr, 0.357580f/0.95046866f, lg, 0.180423f/0.95046866f, lb, 0));
+			const __m128 fy = _lab_f_batch(_combine(0.212671f,             lr, 0.715160f,             lg, 0.072169f,             lb, 0));
+			const __m128 fz = _lab_f_batch(_combine(0.019334f/1.08882331f, lr, 0.119193f/1.08882331f, lg, 0.950227f/1.08882331f, lb, 0));
+
+			_mm_storeu_ps(out,                _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(116.0f), fy), _mm_set1_ps(16.0f)));
+			_mm_storeu_ps(out + batch_size,   _mm_add_ps(_mm_mul_ps(_mm_set1_ps(500.0f), _mm_sub_ps(fx, fy)), _mm_set1_ps(128.0f)));
+			_mm_storeu_ps(out + 2*batch_size, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(200.0f), _mm_sub_ps(fy, fz)), _mm_set1_ps(128.0f)));
+		}
+#endif
+
+		//! Copies a row without conversion
+		template<typename source_type>
+		void _copy_row(const source_type* src, value_data_type* dst, uint64 length) {
+			for (const source_type* end = src + 3*length; src != end; src++, dst++) {
+				*dst = static_cast<value_data_type>(*src);
+			}
+		}
+
+		//! Unknown conversions give zero, as convert(const value_type&, ...)
+		template<typename source_type>
+		void _zero_row(const source_type* /*src*/, value_data_type* dst, uint64 length) {
+			std::fill(dst, dst + 3*length, value_data_type(0));
+		}
+
+		//! sRGB channel in [0,255] to linear intensity in [0,1]
+		inline float64 _linearize(float64 v) const {
+			if (v >= 0 && v < 256) {
+				const uint64 i = (uint64)v;
+				if (i == v) return _srgb_to_linear[i];
+			}
+			const float64 l = v/255.0;
+			if (l < 0.03928) return l / 12.92;
+			return _gamma((l+0.055)/(1.055));
+		}
+
+		//! Linear intensity in [0,1] to sRGB channel in [0,255]
+		inline float64 _delinearize(float64 l) const {
+			if (l < 0.00304) return 255 * 12.92 * l;
+			return 255 * (1.055*_inverse_gamma(l) - 0.055);
+		}
+
+		//! f() of LAB
+		inline float64 _lab_f(float64 t) const {
+			if (t > 0.00885645167903563) return _cube_root(t);	// (6/29)^3
+			return (1.0/3.0)*(29.0/6.0)*(29.0/6.0)*t + 4.0/29.0;
+		}
+
+		void _rgb_to_yuv(const float64* v, float64* p) {
+			p[0] = 0.5 + 16.0  + 1/256.0 * (   65.738  * (v[2]) +  129.057  * (v[1]) +  25.064  * (v[0]) );
+			p[1] = 0.5 + 128.0 + 1/256.0 * ( - 37.945  * (v[2]) -   74.494  * (v[1]) + 112.439  * (v[0]) );
+			p[2] = 0.5 + 128.0 + 1/256.0 * (  112.439  * (v[2]) -   94.154  * (v[1]) -  18.285  * (v[0]) );
+			for (uint64 c = 0; c < 3; c++) p[c] = std::min(std::max(p[c], 0.0), 255.0);
+		}
+
+		void _yuv_to_rgb(const float64* v, float64* p) {
+			const float64 y = v[0];
+			const float64 cb = v[1];
+			const float64 cr = v[2];
+			p[2] = 0.5 + ( 298.082 * y                + 408.583 * cr ) / 256.0 - 222.921;
+			p[1] = 0.5 + ( 298.082 * y - 100.291 * cb - 208.120 * cr ) / 256.0 + 135.576;
+			p[0] = 0.5 + ( 298.082 * y + 516.412 * cb                ) / 256.0 - 276.836;
+			for (uint64 c = 0; c < 3; c++) p[c] = std::min(std::max(p[c], 0.0), 255.0);
+		}
+
+		void _rgb_to_lab(const float64* v, float64* p) {
+			const float64 lr = _linearize(v[2]);
+			const float64 lg = _linearize(v[1]);
+			const float64 lb = _linearize(v[0]);
+
+			const float64 fx = _lab_f((0.412453 * lr + 0.357580 * lg + 0.180423 * lb) / 0.95046866);
+			const float64 fy = _lab_f( 0.212671 * lr + 0.715160 * lg + 0.072169 * lb);
+			const float64 fz = _lab_f((0.019334 * lr + 0.119193 * lg + 0.950227 * lb) / 1.08882331);
+
+			p[0] = 116 * fy - 16;
+			p[1] = 500 * (fx - fy) + 128;
+			p[2] = 200 * (fy - fz) + 128;
+		}
+
+		void _lab_to_rgb(const float64* v, float64* p) {
+			const float64 delta = 6.0 / 29.0;
+
+			const float64 fy = (v[0] + 16) / 116;
+			const float64 fx = fy + (v[1] - 128)/500;
+			const float64 fz = fy - (v[2] - 128)/200;
+
+			const float64 X = (fx > delta) ? 0.95046866 * fx * fx * fx : (fx - 16.0/116.0)*3*delta*delta*0.95046866;
+			const float64 Y = (fy > delta) ? fy * fy * fy : (fy - 16.0/116.0)*3*delta*delta;
+			const float64 Z = (fz > delta) ? 1.08882331 * fz * fz * fz : (fz - 16.0/116.0)*3*delta*delta*1.08882331;
+
+			p[2] = _delinearize( 3.240479 * X - 1.537152 * Y - 0.498536 * Z);
+			p[1] = _delinearize(-0.969255 * X + 1.875990 * Y + 0.041556 * Z);
+			p[0] = _delinearize( 0.055647 * X - 0.204041 * Y + 1.057311 * Z);
+		}
+
+		void _yuv_to_lab(const float64* v, float64* p) {
+			float64 rgb[3];
+			_yuv_to_rgb(v, rgb);
+			_rgb_to_lab(rgb, p);
+		}
+
+		void _lab_to_yuv(const float64* v, float64* p) {
+			float64 rgb[3];
+			_lab_to_rgb(v, rgb);
+			_rgb_to_yuv(rgb, p);
+		}
+
+		//! linear intensity of every 8-bit sRGB value
+		float64 _srgb_to_linear[256];
+
+		//! _srgb_to_linear in float32, for the SIMD kernels
+		float32 _srgb_to_linear_f[256];
+
+		//! x^2.4 in [0,1]
+		PowerTable _gamma;
+
+		//! x^(1/2.4) in [0,1]
+		PowerTable _inverse_gamma;
+
+		//! x^(1/3) in [0,1.25]
+		PowerTable _cube_root;
+
 	protected:
 
+		// Per-value conversions
+
 		inline value_type convert(const value_type& v, ColorSpaceType input, ColorSpaceType output) {
 			if (input == ColorSpaceRGB) {
 				if (output == ColorSpaceRGB) return v;
@@ -9,22 +9,25 @@
 #define IMAGE_SIGNAL_HPP_
 
 #include <opencv2/opencv.hpp>
+#include <imageplus/core/opencv.hpp>
 
 #include <imageplus/core/signal.hpp>
 #include <imageplus/core/colorspaces.hpp>
+#include <imageplus/core/colorspace_converter.hpp>
 
 #include <boost/filesystem.hpp>
 
 namespace imageplus {
 
 	//! Class ImageSignal, base class for all the images
-	template<typename channel_type, uint64 channels>
-	class ImageSignal : public Signal<int64, channel_type, 2, channels> {
+	//! Layout selects the memory layout of the pixels (see SignalContainer): interleaved by default.
+	template<typename channel_type, uint64 channels, class Layout = InterleavedLayout>
+	class ImageSignal : public Signal<int64, channel_type, 2, channels, Layout> {
 
 	public:
 
 		//! base class type
-		typedef Signal<int64, channel_type, 2, channels> 													BaseClassType;
+		typedef Signal<int64, channel_type, 2, channels, Layout> 											BaseClassType;
 
 		//!Vector representing the values of a coord
 		typedef typename BaseClassType::coord_type															coord_type;
@@ -57,7 +60,7 @@ namespace imageplus {
 		static const int64 num_channels = channels;
 
 		//! Default constructor
-		ImageSignal() : BaseClassType() {
+		ImageSignal() : BaseClassType(), _color_space(ColorSpaceRGB), _sx(0), _sy(0) {
 		}
 
 		//! Default constructor
@@ -95,13 +98,13 @@ namespace imageplus {
 
 		//! Returns the x-size of the image
 		//! \return columns of the image
-		inline uint64 size_x() {
+		inline uint64 size_x() const {
 			return _sx;
 		}
 
 		//! Returns the y-size of the image
 		//! \return rows of the image
-		inline uint64 size_y() {
+		inline uint64 size_y() const {
 			return _sy;
 		}
 
@@ -116,17 +119,37 @@ namespace imageplus {
 			_color_space = color_space;
 		}
 
+		//! Uses a buffer owned by another object as the data of the image, without copying it (see Signal::adopt_data)
+		void adopt_data(const coord_type& sizes, value_data_type* data, const boost::shared_ptr<void>& keeper) {
+			BaseClassType::adopt_data(sizes, data, keeper);
+			_sx = sizes(0);
+			_sy = sizes(1);
+		}
+
+		//! View of a channel as a sx x sy matrix. With a planar layout the values of a column of the matrix (a row
+		//! of the image) are contiguous, and aligned if the layout aligns the rows.
 		ChannelType channel(uint64 channel) {
 			value_data_type* data = BaseClassType::data();
-			return ChannelType(data+channel,_sx,_sy, StrideType(_sx*channels,channels));
+			return ChannelType(data + channel*this->channel_stride(), _sx, _sy, StrideType(this->strides()(1), BaseClassType::unit_stride));
 		}
 
 
 		void read(std::string path) {
+			read(path, ColorSpaceRGB);
+		}
+
+		//! Reads an image and converts it to a color space while it is copied into the signal, in one pass
+		//! per row (see ColorSpaceConverter)
+		//! \param[in] path : file to read
+		//! \param[in] color_space : color space of the signal (only RGB for images with other than 3 channels)
+		void read(std::string path, ColorSpaceType color_space) {
 			if ( !boost::filesystem::exists(path) ) {
 			  std::cerr << "Could not read file: " << path << std::endl;
 			  throw;
 			}
+			if (channels != 3 && color_space != ColorSpaceRGB) {
+				throw ImagePlusError("Only images with 3 channels can be read in a color space other than RGB");
+			}
 			cv::Mat img;
 			if (channels > 1) {
 				img = cv::imread(path, CV_LOAD_IMAGE_COLOR);
@@ -134,25 +157,44 @@ namespace imageplus {
 				img = cv::imread(path, CV_LOAD_IMAGE_GRAYSCALE);
 			}
 
+			if (color_space == ColorSpaceRGB && is_adoptable<ImageSignal>(img)) {
+				// the decoded buffer has the layout of the signal, so it is shared instead of copied
+				adopt_data(coord_type(img.cols,img.rows), reinterpret_cast<value_data_type*>(img.data), boost::shared_ptr<void>(new cv::Mat(img)));
+				_color_space = color_space;
+				return;
+			}
+
 			_sx = img.cols;
 			_sy = img.rows;
 
-			//uint64 size = _sx*_sy*num_channels*sizeof(value_data_type);
-
 			// Add a reference counter since now we are responsible of the image
 			BaseClassType::init_data(coord_type(_sx,_sy));
 
 			value_data_type* data = BaseClassType::data();
-
-			// export_to transfer the data from img to buffer
-			for(uint64 i = 0; i < _sy; i++)
-			{
-				uint8* m = img.ptr<uint8>(i);
-			    for(uint64 j = 0; j < _sx*num_channels; j++)
-			        (*data++) += static_cast<value_data_type>(m[j]);
+			const int64 row_stride = this->strides()(1);
+
+			if (color_space == ColorSpaceRGB || Layout::planar) {
+				// export_to transfer the data from img to buffer
+				const int64 channel_stride = this->channel_stride();
+				for(uint64 i = 0; i < _sy; i++, data += row_stride)
+				{
+					uint8* m = img.ptr<uint8>(i);
+					for(uint64 j = 0; j < _sx; j++)
+						for(uint64 c = 0; c < channels; c++)
+							data[j*BaseClassType::unit_stride + c*channel_stride] = static_cast<value_data_type>(*m++);
+				}
+				// planar values are converted after the copy
+				if (color_space != ColorSpaceRGB) {
+					ColorSpaceConverter<ImageSignal> converter;
+					converter.convert(*this, color_space);
+				}
+			} else {
+				// decoded rows are converted directly into the buffer
+				ColorSpaceConverter<ImageSignal> converter;
+				converter.convert(img.ptr<uint8>(0), img.step1(), data, row_stride, _sx, _sy, ColorSpaceRGB, color_space);
 			}
 
-			_color_space = ColorSpaceRGB;
+			_color_space = color_space;
 		}
 
 		void write(std::string path) {
@@ -161,6 +203,16 @@ namespace imageplus {
 				return;
 			}
 
+			if (!BaseClassType::packed) {
+				// OpenCV needs packed interleaved pixels
+				ImageSignal<channel_type, channels> interleaved(_sx,_sy);
+				for (uint64 y = 0; y < _sy; y++)
+					for (uint64 x = 0; x < _sx; x++)
+						interleaved(x,y) = (*this)(x,y);
+				interleaved.write(path);
+				return;
+			}
+
 			// import_from transfer the data from buffer to img
 			int type = CV_MAKETYPE(cv::DataType<value_data_type>::depth, channels);
 
@@ -174,12 +226,12 @@ namespace imageplus {
 				//throw;
 		}
 
-		value_float_type interpolate_value(float64 x, float64 y) {
+		value_float_type interpolate_value(float64 x, float64 y) const {
 			return interpolate_value(coord_float_type(x,y));
 		}
 
-		//! Provides a method for bilinear interpolation
-		value_float_type interpolate_value(coord_float_type v) {
+		//! Provides a method for bilinear interpolation. The image is only read, so shared data is not copied.
+		value_float_type interpolate_value(coord_float_type v) const {
 			value_float_type p = value_float_type::Zero();
 
 			//Check for bounds
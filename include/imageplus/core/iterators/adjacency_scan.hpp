@@ -0,0 +1,131 @@
+/*
+ * adjacency_scan.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef ADJACENCY_SCAN_HPP_
+#define ADJACENCY_SCAN_HPP_
+
+#include <imageplus/core/iterators/space_neighbors.hpp>
+#include <imageplus/core/iterators/span_iterator.hpp>
+#include <boost/static_assert.hpp>
+
+namespace imageplus {
+
+	//! Linear displacements (in units) of the neighbors of a connectivity for a given signal size
+	template<class Signal, ConnectivityType connectivity>
+	struct neighbor_offsets {
+
+		typedef typename Signal::coord_type														coord_type;
+
+		//! neighborhood structure
+		typedef Neighborhood<typename Signal::coord_data_type, Signal::coord_dimensions, connectivity>	NeighborhoodType;
+
+		//! number of neighbors of the connectivity
+		static const uint64 num_neighbors = NeighborhoodType::NeighborhoodType::static_size;
+
+		//! neighbors as coordinates
+		NeighborhoodType neighborhood;
+
+		//! neighbors as displacements from the central unit
+		boost::array<int64, num_neighbors> offsets;
+
+		//! maximum distance of a neighbor in every dimension (units closer to the border are checked)
+		coord_type margin;
+
+		//! Constructor
+		//! \param[in] sizes : sizes of the signal
+		neighbor_offsets(const coord_type& sizes) {
+			margin.fill(0);
+			for (uint64 n = 0; n < num_neighbors; n++) {
+				int64 stride = 1;
+				offsets[n] = 0;
+				for (uint64 k = 0; k < Signal::coord_dimensions; k++) {
+					int64 d = neighborhood.neighbors[n](k);
+					offsets[n] += d*stride;
+					stride *= sizes(k);
+					if (d < 0) d = -d;
+					if (d > margin(k)) margin(k) = d;
+				}
+			}
+		}
+	};
+
+	//! Visits every pair (unit, neighbor) of a signal for a given connectivity.
+	//! The domain is split in interior and border: interior units use the precomputed offsets without any bounds check,
+	//! while units closer to the border than the neighborhood are checked as in general_adjacency_iterator_type.
+	//! The visitor is called as visitor(unit, neighbor), both being indices of units in the dense array data() of a
+	//! packed signal (the values of unit u start at data() + u*value_dimensions). Only packed signals can be scanned.
+	//! The signal is only read, so shared data is not copied.
+	//! \param[in] signal : signal to scan
+	//! \param[in] visitor : functor called for every pair
+	template<ConnectivityType connectivity, class Signal, class Visitor>
+	void scan_adjacencies(const Signal& signal, Visitor& visitor) {
+		// the unit indices address a dense array
+		BOOST_STATIC_ASSERT(Signal::packed);
+
+		typedef typename Signal::coord_type				coord_type;
+		typedef neighbor_offsets<Signal, connectivity>	OffsetsType;
+
+		const coord_type sizes = signal.sizes();
+		const coord_type lower = signal.lower_point();
+
+		OffsetsType n(sizes);
+
+		typename Signal::const_span_iterator s = signal.span_begin();
+		typename Signal::const_span_iterator s_end = signal.span_end();
+
+		uint64 unit = 0;
+		for (; s != s_end; ++s) {
+			const uint64 length = s->length;
+
+			// relative position of the span
+			coord_type rel = s->pos - lower;
+
+			bool interior_row = (length >= 2*(uint64)n.margin(0));
+			for (uint64 k = 1; k < Signal::coord_dimensions; k++) {
+				if (rel(k) < n.margin(k) || rel(k) >= sizes(k) - n.margin(k)) interior_row = false;
+			}
+
+			uint64 first = length;
+			uint64 last = length;
+			if (interior_row) {
+				first = n.margin(0);
+				last = length - n.margin(0);
+			}
+
+			// checked units at the beginning of the span (the whole span if it is on the border)
+			for (uint64 i = 0; i < first; i++, rel(0)++) {
+				for (uint64 k = 0; k < OffsetsType::num_neighbors; k++) {
+					coord_type c = rel + n.neighborhood.neighbors[k];
+					if ((c.array() >= 0).all() && (c.array() < sizes.array()).all())
+						visitor(unit + i, unit + i + n.offsets[k]);
+				}
+			}
+
+			// interior units, no checks
+			for (uint64 i = first; i < last; i++) {
+				for (uint64 k = 0; k < OffsetsType::num_neighbors; k++) {
+					visitor(unit + i, unit + i + n.offsets[k]);
+				}
+			}
+
+			// checked units at the end of the span
+			rel(0) = last;
+			for (uint64 i = last; i < length; i++, rel(0)++) {
+				for (uint64 k = 0; k < OffsetsType::num_neighbors; k++) {
+					coord_type c = rel + n.neighborhood.neighbors[k];
+					if ((c.array() >= 0).all() && (c.array() < sizes.array()).all())
+						visitor(unit + i, unit + i + n.offsets[k]);
+				}
+			}
+
+			unit += length;
+		}
+	}
+
+}
+
+#endif /* ADJACENCY_SCAN_HPP_ */
@@ -67,6 +67,37 @@ namespace imageplus {
 		static const ConnectivityType default_forward_connectivity = Connectivity3D3;
 	};
 
+	//! connectivity traits
+	template<ConnectivityType connectivity>
+	struct connectivity_traits {
+		//! true if the opposite of every neighbor is also a neighbor
+		static const bool symmetric = true;
+	};
+
+	//! forward connectivity traits for 1D
+	template<>
+	struct connectivity_traits<Connectivity1D1> {
+		static const bool symmetric = false;
+	};
+
+	//! forward connectivity traits for 2D
+	template<>
+	struct connectivity_traits<Connectivity2D2> {
+		static const bool symmetric = false;
+	};
+
+	//! forward connectivity traits for 3D
+	template<>
+	struct connectivity_traits<Connectivity3D3> {
+		static const bool symmetric = false;
+	};
+
+	//! forward same plane connectivity traits for 3D
+	template<>
+	struct connectivity_traits<Connectivity3D2> {
+		static const bool symmetric = false;
+	};
+
 	//! Class Neighborhood
 	template<typename coords_type, uint64 dimensions, ConnectivityType connectivity>
 	struct Neighborhood{
@@ -224,8 +255,8 @@ namespace imageplus {
 
 			neighbors[18](0) =  1;  neighbors[18](1) =  1;  neighbors[18](2) = 1;
 			neighbors[19](0) = -1;  neighbors[19](1) = 1;   neighbors[19](2) = 1;
-			neighbors[20](0) = 1;   neighbors[20](1) = -1;  neighbors[20](2) = -1;
-			neighbors[21](0) = -1;  neighbors[21](1) = -1;  neighbors[21](2) = -1;
+			neighbors[20](0) = 1;   neighbors[20](1) = -1;  neighbors[20](2) = 1;
+			neighbors[21](0) = -1;  neighbors[21](1) = -1;  neighbors[21](2) = 1;
 
 			neighbors[22](0) =  1;  neighbors[22](1) =  1;  neighbors[22](2) = -1;
 			neighbors[23](0) = -1;  neighbors[23](1) = 1;   neighbors[23](2) = -1;
@@ -303,7 +334,7 @@ namespace imageplus {
 			neighbors[0](0) = 1;  neighbors[0](1) = 0;  neighbors[0](2) = 0;
 			neighbors[1](0) = 0;  neighbors[1](1) = 1;  neighbors[1](2) = 0;
 			neighbors[2](0) = -1;  neighbors[2](1) = 0;  neighbors[2](2) = 0;
-			neighbors[2](0) = 0;  neighbors[2](1) = -1;  neighbors[2](2) = 0;
+			neighbors[3](0) = 0;  neighbors[3](1) = -1;  neighbors[3](2) = 0;
 		}
 	};
 
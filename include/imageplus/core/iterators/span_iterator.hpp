@@ -0,0 +1,159 @@
+/*
+ * span_iterator.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef SPAN_ITERATOR_HPP_
+#define SPAN_ITERATOR_HPP_
+
+#include <imageplus/math/math_types.hpp>
+
+namespace imageplus {
+
+	//! Types seen through a span of a signal: writable, or read-only when is_const is true. Read-only spans are
+	//! obtained through the const data() of the signal, so they do not make shared data unique.
+	template<class Signal, bool is_const>
+	struct span_access {
+		typedef Signal									signal_type;
+		typedef typename Signal::value_data_type		value_data_type;
+		typedef typename Signal::value_ret_type			value_ret_type;
+	};
+
+	//! Types seen through a read-only span of a signal
+	template<class Signal>
+	struct span_access<Signal, true> {
+		typedef const Signal							signal_type;
+		typedef const typename Signal::value_data_type	value_data_type;
+		typedef typename Signal::value_const_ret_type	value_ret_type;
+	};
+
+	//! Contiguous run of units along the first (innermost) dimension of a signal. Channel c of unit i is at
+	//! data[i*Signal::unit_stride + c*channel_stride] (data[i*value_dimensions + c] for interleaved layouts).
+	template<class Signal, bool is_const = false>
+	struct signal_span {
+
+		typedef typename Signal::coord_type							coord_type;
+		typedef typename span_access<Signal,is_const>::value_data_type	value_data_type;
+		typedef typename span_access<Signal,is_const>::value_ret_type	value_ret_type;
+
+		//! pointer to the first value of the run
+		value_data_type* data;
+
+		//! number of units in the run
+		uint64 length;
+
+		//! distance between two channels of a unit (1 for interleaved layouts)
+		int64 channel_stride;
+
+		//! coordinate of the first unit of the run
+		coord_type pos;
+
+		//! Returns the i-th unit of the run
+		//! \param[in] i : position inside the run
+		//! \return unit at pos + (i,0,...)
+		inline value_ret_type operator[](uint64 i) const {
+			return Signal::unit_map_type::template make<value_ret_type>(data + i*Signal::unit_stride, channel_stride);
+		}
+	};
+
+	//! Class to iterate accross the whole signal one row (span of the first dimension) at a time.
+	//! Inside a span, units are contiguous in memory and must be visited incrementing the data pointer by unit_stride
+	//! (value_dimensions for interleaved layouts). With is_const the signal is only read.
+	template<class Signal, bool is_const = false>
+	class span_iterator_type : public std::iterator<std::forward_iterator_tag, signal_span<Signal,is_const> > {
+
+		typedef typename Signal::coord_type coord_type;
+		typedef typename span_access<Signal,is_const>::signal_type signal_type;
+
+	public:
+
+		typedef signal_span<Signal,is_const>	span_type;
+
+		//! default constructor
+		//! \param[in] signal : signal to iterate
+		//! \param[in] end : true if the end_iterator is created
+		span_iterator_type(signal_type* signal, bool end) : _signal(signal) {
+			_sizes = _signal->sizes();
+			_end = end || _sizes.prod() == 0;
+
+			_span.pos = _signal->lower_point();
+			_span.length = _sizes(0);
+			_span.data = _signal->data();
+			_span.channel_stride = _signal->channel_stride();
+
+			// distance between two consecutive spans (rows can be padded)
+			_row_step = (Signal::coord_dimensions == 1) ? _sizes(0)*Signal::unit_stride : _signal->strides()(1);
+		}
+
+		//! operator ++ overload, moves to the next span
+		//! \return itself
+		span_iterator_type& operator++() {
+			if (_end) return *this;
+
+			_span.data += _row_step;
+
+			if (Signal::coord_dimensions == 1) {_end = true; return *this;}
+
+			const coord_type& lower = _signal->lower_point();
+
+			uint64 i = 1;
+			_span.pos(i)++;
+			while (_span.pos(i) - lower(i) >= _sizes(i)) {
+				if (i == Signal::coord_dimensions-1) {_end = true; return *this;}
+				_span.pos(i) = lower(i);
+				i++;
+				_span.pos(i)++;
+			}
+
+			return *this;
+		}
+
+		//! operator != overload
+		//! \return boolean indicating whether or not a != *this
+		bool operator!=(const span_iterator_type& a) const {
+			if (a._end && _end) return false;
+			if (a._end || _end) return true;
+
+			return (a._span.data != _span.data);
+		}
+
+		//! dereference operator
+		//! \return the current span
+		const span_type& operator*() const {
+			return _span;
+		}
+
+		//! dereference operator
+		//! \return the current span
+		const span_type* operator->() const {
+			return &_span;
+		}
+
+		//! Returns the coordinate of the first unit of the span
+		const coord_type& pos() const {
+			return _span.pos;
+		}
+
+	protected:
+
+		//! signal
+		signal_type *_signal;
+
+		//! size for every dimension
+		coord_type _sizes;
+
+		//! current span
+		span_type _span;
+
+		//! memory displacement between two spans
+		uint64 _row_step;
+
+		//! end iterator
+		bool _end;
+	};
+
+}
+
+#endif /* SPAN_ITERATOR_HPP_ */
@@ -10,6 +10,9 @@
 
 #include <opencv2/opencv.hpp>
 
+#include <imageplus/core/exceptions.hpp>
+#include <boost/shared_ptr.hpp>
+
 namespace imageplus {
 
 	template<class Signal>
@@ -29,15 +32,62 @@ namespace imageplus {
 			sizes[2] = s.sizes()(2);
 		}
 
+		if (Signal::layout_type::planar && s.value_dimensions > 1) {
+			throw ImagePlusError("to_opencv: planar signals can not be wrapped in a matrix");
+		}
+
+		// padded rows
+		if (!Signal::packed && s.coord_dimensions == 2) {
+			return cv::Mat(sizes[0], sizes[1], type, s.data(), s.strides()(1)*sizeof(typename Signal::value_data_type));
+		}
+
 		cv::Mat out(s.coord_dimensions, sizes, type, s.data());
 
 		return out;
 	}
 
-	/*template<class Signal>
+	//! Returns whether the data of a cv::Mat can be used as the data of a signal without copying it: same value
+	//! type and number of channels, continuous memory and a packed layout of the signal
+	template<class Signal>
+	bool is_adoptable(const cv::Mat& m) {
+		int type = CV_MAKETYPE(cv::DataType<typename Signal::value_data_type>::depth, Signal::value_dimensions);
+		int dims = (Signal::coord_dimensions == 3) ? 3 : 2;
+		return Signal::packed && m.data != NULL && m.isContinuous() && m.type() == type && m.dims == dims;
+	}
+
+	//! Wraps the data of a cv::Mat in a signal without copying it (the inverse of to_opencv). The signal shares
+	//! the ownership of the data with m, so it stays valid when m and its copies are released.
+	//! \param[in] m : matrix, is_adoptable<Signal>(m) must be true
+	//! \param[out] s : signal using the data of m
+	template<class Signal>
+	void to_imageplus(cv::Mat& m, Signal& s) {
+		if (!is_adoptable<Signal>(m)) {
+			throw ImagePlusError("to_imageplus: the type, channels or layout of the matrix do not match the signal");
+		}
+
+		typename Signal::coord_type sizes;
+
+		if (s.coord_dimensions == 1) sizes(0) = m.total();
+		if (s.coord_dimensions == 2) {
+			sizes(0) = m.size[1];
+			sizes(1) = m.size[0];
+		}
+		if (s.coord_dimensions == 3) {
+			sizes(0) = m.size[1];
+			sizes(1) = m.size[0];
+			sizes(2) = m.size[2];
+		}
+
+		s.adopt_data(sizes, reinterpret_cast<typename Signal::value_data_type*>(m.data), boost::shared_ptr<void>(new cv::Mat(m)));
+	}
+
+	//! Wraps the data of a cv::Mat in a signal without copying it (see to_imageplus(cv::Mat&, Signal&))
+	template<class Signal>
 	Signal to_imageplus(cv::Mat& m) {
-		//return Signal(m,);
-	}*/
+		Signal s;
+		to_imageplus(m, s);
+		return s;
+	}
 
 }
 
@@ -0,0 +1,220 @@
+/*
+ * parallel_descriptors.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef PARALLEL_DESCRIPTORS_HPP_
+#define PARALLEL_DESCRIPTORS_HPP_
+
+#include <imageplus/core/visual_descriptors.hpp>
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace imageplus {
+
+	//! Computes a recursive descriptor of a region of a binary hierarchy with several threads.
+	//!
+	//! The tree is cut into independent subtrees (tasks) splitting the biggest one until there are enough tasks for
+	//! the threads or the biggest one is below a minimum size. The threads take the tasks from a shared list, biggest
+	//! first, and compute each one sequentially in post-order (from the signal for the leaves and from the children
+	//! for the rest, as calc_descriptor does). The regions above the cut are combined as soon as all their children
+	//! are ready, by the thread that finished the last one.
+	//!
+	//! Every region is only accessed by one thread at a time, so no lock is needed on the CollaborativeDescriptors
+	//! of the regions. The threads share the input, which must only be read by colors_begin/colors_end (as
+	//! SignalRegionInput does, through the const accessors of the signal, so a shared signal is never made unique).
+	template<class VDModel, class InputModel, class RegionModel>
+	class ParallelDescriptorCalculator {
+	public:
+
+		typedef typename RegionModel::RegionPointer RegPointer;
+
+		//! Constructor
+		//! \param[in] input : data of the regions
+		//! \param[in] num_threads : number of threads (0 to use all the available cores)
+		//! \param[in] min_task_size : subtrees with fewer regions are not split in smaller tasks
+		ParallelDescriptorCalculator(InputModel& input, uint64 num_threads = 0, uint64 min_task_size = 1024) : _input(input), _num_threads(num_threads), _min_task_size(min_task_size), _prototype(NULL) {
+			if (_num_threads == 0) _num_threads = boost::thread::hardware_concurrency();
+			if (_num_threads == 0) _num_threads = 1;
+			if (_min_task_size == 0) _min_task_size = 1;
+		}
+
+		//! Computes the descriptor of a region and all its descendants whose descriptor is not calculated
+		//! \param[in] desc : pointer to a new descriptor object of the type we want to compute (owned by the calculator)
+		//! \param[in] region : region to describe
+		//! \return the calculated descriptor
+		VDModel& calculate(VDModel* desc, RegionModel& region) {
+			if (_num_threads == 1 || !desc->is_recursive()) return calc_descriptor(desc, _input, region);
+
+			_prototype = desc;
+			_sort_post_order(&region);
+			_split();
+
+			boost::thread_group threads;
+			for (uint64 t = 0; t < _num_threads; t++) {
+				threads.add_thread(new boost::thread(&ParallelDescriptorCalculator::_work, this));
+			}
+			threads.join_all();
+
+			VDModel& result = region.coll_vd().get(*desc);
+			delete desc;
+			_prototype = NULL;
+			return result;
+		}
+
+	protected:
+
+		//! Lists the regions to compute in post-order, with the number of regions of their subtree.
+		//! Regions with the descriptor calculated are not expanded.
+		void _sort_post_order(RegPointer root) {
+			_nodes.clear();
+			_sizes.clear();
+
+			// (region, index of its first descendant in _nodes)
+			std::vector<std::pair<RegPointer, uint64> > stack;
+			stack.push_back(std::make_pair(root, 0));
+			std::vector<bool> expanded(1, false);
+			while (!stack.empty()) {
+				RegPointer r = stack.back().first;
+				bool leaf = r->parts().size() == 0 || r->coll_vd().is_calculated(_prototype->slot());
+				if (!leaf && !expanded.back()) {
+					expanded.back() = true;
+					stack.back().second = _nodes.size();
+					for (uint64 i = r->parts().size(); i > 0; i--) {
+						stack.push_back(std::make_pair(r->parts()[i-1], 0));
+						expanded.push_back(false);
+					}
+				} else {
+					uint64 first = leaf ? _nodes.size() : stack.back().second;
+					_nodes.push_back(r);
+					_sizes.push_back(_nodes.size() - first);
+					stack.pop_back();
+					expanded.pop_back();
+				}
+			}
+		}
+
+		//! Cuts the tree in tasks and lists the regions above them
+		void _split() {
+			const uint64 n = _nodes.size();
+			const uint64 target = 8*_num_threads;
+
+			_parent.assign(n, -1);
+			_pending.assign(n, 0);
+			_tasks.clear();
+
+			// biggest subtree first
+			std::priority_queue<std::pair<uint64, uint64> > candidates;
+			candidates.push(std::make_pair(_sizes[n-1], n-1));
+			while (!candidates.empty() && candidates.size() < target && candidates.top().first > _min_task_size) {
+				uint64 i = candidates.top().second;
+				candidates.pop();
+
+				// children of i are before it in post-order, each one after the subtree of the previous one
+				uint64 j = i - 1;
+				for (uint64 c = 0; c < _nodes[i]->parts().size(); c++) {
+					_parent[j] = i;
+					_pending[i]++;
+					candidates.push(std::make_pair(_sizes[j], j));
+					j -= _sizes[j];
+				}
+			}
+
+			while (!candidates.empty()) {
+				_tasks.push_back(candidates.top().second);
+				candidates.pop();
+			}
+			_next_task = 0;
+		}
+
+		//! Computes tasks until there are no more
+		void _work() {
+			while (true) {
+				uint64 i;
+				{
+					boost::mutex::scoped_lock lock(_mutex);
+					if (_next_task == _tasks.size()) return;
+					i = _tasks[_next_task++];
+				}
+				for (uint64 k = i + 1 - _sizes[i]; k <= i; k++) _compute(_nodes[k]);
+
+				// combine the regions above the task whose children are all ready
+				for (int64 p = _parent[i]; p >= 0; p = _parent[p]) {
+					{
+						boost::mutex::scoped_lock lock(_mutex);
+						if (--_pending[p] > 0) break;
+					}
+					_compute(_nodes[p]);
+				}
+			}
+		}
+
+		//! Computes the descriptor of a region whose children are ready
+		inline void _compute(RegPointer r) {
+			CollaborativeDescriptors& vd = r->coll_vd();
+			if (vd.is_calculated(_prototype->slot())) return;
+
+			if (r->parts().size() == 0) {
+				vd.calculate(new VDModel(*_prototype), _input.colors_begin(*r), _input.colors_end(*r), &_input.coll_vd());
+			} else {
+				vd.recursive_calculate(new VDModel(*_prototype), r->parts()[0]->coll_vd(), r->parts()[1]->coll_vd(), &_input.coll_vd());
+			}
+		}
+
+		//! data of the regions
+		InputModel& _input;
+
+		//! number of threads
+		uint64 _num_threads;
+
+		//! minimum number of regions of a subtree to split it
+		uint64 _min_task_size;
+
+		//! descriptor being calculated
+		VDModel* _prototype;
+
+		//! regions to compute in post-order
+		std::vector<RegPointer> _nodes;
+
+		//! number of regions of the subtree of every region in _nodes
+		std::vector<uint64> _sizes;
+
+		//! index in _nodes of the parent of the regions above the cut and the tasks (-1 for the root)
+		std::vector<int64> _parent;
+
+		//! children not ready of the regions above the cut
+		std::vector<uint64> _pending;
+
+		//! roots of the tasks, biggest first
+		std::vector<uint64> _tasks;
+
+		//! next task to compute
+		uint64 _next_task;
+
+		//! lock of _next_task and _pending
+		boost::mutex _mutex;
+	};
+
+	//! Helper function to compute a visual descriptor of a region of a hierarchy with several threads
+	//! (see ParallelDescriptorCalculator). The result is the same as with calc_descriptor.
+	//!
+	//! \param[in] desc: Pointer to a new descriptor object of the type we want to compute
+	//! \param[in] input: The descriptor will be computed using this data
+	//! \param[in] region: The descriptor will be computed on this region
+	//! \param[in] num_threads: Number of threads (0 to use all the available cores)
+	//!
+	//! \returns the calculated descriptor
+	template<class VDModel, class InputModel, class RegionModel>
+	VDModel& calc_descriptor(VDModel* desc, InputModel& input, RegionModel& region, uint64 num_threads) {
+		ParallelDescriptorCalculator<VDModel, InputModel, RegionModel> calculator(input, num_threads);
+		return calculator.calculate(desc, region);
+	}
+
+}
+
+#endif /* PARALLEL_DESCRIPTORS_HPP_ */
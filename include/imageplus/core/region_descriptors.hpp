@@ -0,0 +1,343 @@
+/*
+ * region_descriptors.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef REGION_DESCRIPTORS_HPP_
+#define REGION_DESCRIPTORS_HPP_
+
+#include <imageplus/core/visual_descriptors.hpp>
+#include <boost/array.hpp>
+#include <boost/static_assert.hpp>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace imageplus {
+
+	//! Iterator through the values of a signal at the coordinates of a region. The signal is only read, so its data is
+	//! not made unique and several threads can iterate it at the same time.
+	template<class RegionModel, class SignalModel>
+	class region_values_iterator {
+	public:
+
+		typedef typename RegionModel::iterator			region_iterator;
+		typedef typename RegionModel::coord_type		coord_type;
+		typedef typename SignalModel::value_const_ret_type	value_ret_type;
+
+		//! Constructor
+		//! \param[in] it : iterator of the region coordinates
+		//! \param[in] signal : signal
+		region_values_iterator(region_iterator it, const SignalModel* signal) : _it(it), _signal(signal) {
+		}
+
+		bool operator!=(const region_values_iterator& other) const {
+			return _it != other._it;
+		}
+
+		region_values_iterator& operator++() {
+			++_it;
+			return *this;
+		}
+
+		//! \return value of the signal at the current coordinate
+		value_ret_type operator*() {
+			return (*_signal)(*_it);
+		}
+
+		//! \return current coordinate
+		const coord_type& pos() {
+			return *_it;
+		}
+
+	protected:
+
+		//! iterator of the region coordinates
+		region_iterator _it;
+
+		//! signal
+		const SignalModel* _signal;
+	};
+
+	//! Input to compute descriptors of regions over a signal with calc_descriptor
+	template<class SignalModel>
+	class SignalRegionInput : public collaborative_descriptors_traits {
+	public:
+
+		//! Constructor
+		//! \param[in] signal : signal to describe
+		SignalRegionInput(const SignalModel& signal) : _signal(signal) {
+		}
+
+		template<class RegionModel>
+		region_values_iterator<RegionModel, SignalModel> colors_begin(RegionModel& region) {
+			return region_values_iterator<RegionModel, SignalModel>(region.begin(), &_signal);
+		}
+
+		template<class RegionModel>
+		region_values_iterator<RegionModel, SignalModel> colors_end(RegionModel& region) {
+			return region_values_iterator<RegionModel, SignalModel>(region.end(), &_signal);
+		}
+
+	protected:
+
+		//! signal to describe
+		const SignalModel& _signal;
+	};
+
+	//! Number of units of a region
+	class VDArea : public DescriptorBase {
+	public:
+
+		VDArea() : DescriptorBase("Area", true, DescriptorRegistry::slot_of<VDArea>("Area")), _area(0) {
+		}
+
+		template<class IterModel>
+		void calculate(IterModel first, IterModel last, CollaborativeDescriptors* /*peer_descs*/) {
+			for (_area = 0; first != last; ++first) _area++;
+		}
+
+		void recursive_calculate(CollaborativeDescriptors& son1_descs, CollaborativeDescriptors& son2_descs, CollaborativeDescriptors* /*peer_descs*/) {
+			_area = son1_descs.get(*this).area() + son2_descs.get(*this).area();
+		}
+
+		DescriptorBase* clone() const {
+			return new VDArea(*this);
+		}
+
+		//! Sets the descriptor of a label from its statistics (see segmentation::LeafStatistics)
+		template<class StatisticsModel>
+		void assign(const StatisticsModel& statistics, uint64 label) {
+			_area = statistics.count(label);
+		}
+
+		uint64 area() const {
+			return _area;
+		}
+
+	protected:
+
+		uint64 _area;
+	};
+
+	//! Mean value of the units of a region
+	template<uint64 channels>
+	class VDMeanValue : public DescriptorBase {
+	public:
+
+		//! Identifier of the descriptor, with its number of channels (e.g. "MeanValue<3>"), so that mean values
+		//! with different numbers of channels are stored in different slots
+		static const std::string& type_id() {
+			static const std::string id = _make_id();
+			return id;
+		}
+
+		VDMeanValue() : DescriptorBase(type_id(), true, DescriptorRegistry::slot_of<VDMeanValue>(type_id())), _count(0) {
+			_sum.fill(0);
+		}
+
+		template<class IterModel>
+		void calculate(IterModel first, IterModel last, CollaborativeDescriptors* /*peer_descs*/) {
+			_sum.fill(0);
+			for (_count = 0; first != last; ++first, _count++) {
+				for (uint64 c = 0; c < channels; c++) _sum[c] += (*first)(c);
+			}
+		}
+
+		void recursive_calculate(CollaborativeDescriptors& son1_descs, CollaborativeDescriptors& son2_descs, CollaborativeDescriptors* /*peer_descs*/) {
+			const VDMeanValue& d1 = son1_descs.get(*this);
+			const VDMeanValue& d2 = son2_descs.get(*this);
+			_count = d1._count + d2._count;
+			for (uint64 c = 0; c < channels; c++) _sum[c] = d1._sum[c] + d2._sum[c];
+		}
+
+		DescriptorBase* clone() const {
+			return new VDMeanValue(*this);
+		}
+
+		//! Sets the descriptor of a label from its statistics (see segmentation::LeafStatistics)
+		template<class StatisticsModel>
+		void assign(const StatisticsModel& statistics, uint64 label) {
+			_count = statistics.count(label);
+			for (uint64 c = 0; c < channels; c++) _sum[c] = statistics.sum(label, c);
+		}
+
+		//! \return mean of the channel c
+		float64 mean(uint64 c) const {
+			return _sum[c] / _count;
+		}
+
+		//! \return number of units
+		uint64 count() const {
+			return _count;
+		}
+
+	protected:
+
+		static std::string _make_id() {
+			std::ostringstream id;
+			id << "MeanValue<" << channels << ">";
+			return id.str();
+		}
+
+		boost::array<float64, channels> _sum;
+		uint64 _count;
+	};
+
+	//! Bounding box of the coordinates of a region
+	template<uint64 dimensions>
+	class VDBoundingBox : public DescriptorBase {
+	public:
+
+		//! Identifier of the descriptor, with its number of dimensions (e.g. "BoundingBox<2>"), so that bounding
+		//! boxes with different numbers of dimensions are stored in different slots
+		static const std::string& type_id() {
+			static const std::string id = _make_id();
+			return id;
+		}
+
+		VDBoundingBox() : DescriptorBase(type_id(), true, DescriptorRegistry::slot_of<VDBoundingBox>(type_id())) {
+			_min.fill(std::numeric_limits<int64>::max());
+			_max.fill(std::numeric_limits<int64>::min());
+		}
+
+		template<class IterModel>
+		void calculate(IterModel first, IterModel last, CollaborativeDescriptors* /*peer_descs*/) {
+			_min.fill(std::numeric_limits<int64>::max());
+			_max.fill(std::numeric_limits<int64>::min());
+			for (; first != last; ++first) {
+				for (uint64 k = 0; k < dimensions; k++) {
+					int64 x = first.pos()(k);
+					if (x < _min[k]) _min[k] = x;
+					if (x > _max[k]) _max[k] = x;
+				}
+			}
+		}
+
+		void recursive_calculate(CollaborativeDescriptors& son1_descs, CollaborativeDescriptors& son2_descs, CollaborativeDescriptors* /*peer_descs*/) {
+			const VDBoundingBox& d1 = son1_descs.get(*this);
+			const VDBoundingBox& d2 = son2_descs.get(*this);
+			for (uint64 k = 0; k < dimensions; k++) {
+				_min[k] = std::min(d1._min[k], d2._min[k]);
+				_max[k] = std::max(d1._max[k], d2._max[k]);
+			}
+		}
+
+		DescriptorBase* clone() const {
+			return new VDBoundingBox(*this);
+		}
+
+		//! Sets the descriptor of a label from its statistics (see segmentation::LeafStatistics)
+		template<class StatisticsModel>
+		void assign(const StatisticsModel& statistics, uint64 label) {
+			for (uint64 k = 0; k < dimensions; k++) {
+				_min[k] = statistics.min(label, k);
+				_max[k] = statistics.max(label, k);
+			}
+		}
+
+		//! \return lowest coordinate in dimension k
+		int64 min(uint64 k) const {
+			return _min[k];
+		}
+
+		//! \return highest coordinate in dimension k (inclusive)
+		int64 max(uint64 k) const {
+			return _max[k];
+		}
+
+	protected:
+
+		static std::string _make_id() {
+			std::ostringstream id;
+			id << "BoundingBox<" << dimensions << ">";
+			return id.str();
+		}
+
+		boost::array<int64, dimensions> _min;
+		boost::array<int64, dimensions> _max;
+	};
+
+	//! Histogram of every channel of the units of a region, with bins uniformly distributed in [lower, upper)
+	template<uint64 channels, uint64 bins>
+	class VDHistogram : public DescriptorBase {
+	public:
+
+		//! Identifier of the descriptor, with its channels, bins and range (e.g. "Histogram<3,16>[0,256)"), so
+		//! that histograms with different sizes or ranges are stored in different slots
+		//! \param[in] lower : lowest value of the first bin
+		//! \param[in] upper : upper limit of the last bin
+		static std::string type_id(float64 lower = 0, float64 upper = 256) {
+			std::ostringstream id;
+			id.precision(17);
+			id << "Histogram<" << channels << "," << bins << ">[" << lower << "," << upper << ")";
+			return id.str();
+		}
+
+		//! Constructor
+		//! \param[in] lower : lowest value of the first bin
+		//! \param[in] upper : upper limit of the last bin (values out of range go to the first or last bin)
+		VDHistogram(float64 lower = 0, float64 upper = 256) : DescriptorBase(type_id(lower, upper), true, _slot_of(lower, upper)), _lower(lower), _upper(upper) {
+			_counts.fill(0);
+		}
+
+		template<class IterModel>
+		void calculate(IterModel first, IterModel last, CollaborativeDescriptors* /*peer_descs*/) {
+			const float64 scale = bins / (_upper - _lower);
+			_counts.fill(0);
+			for (; first != last; ++first) {
+				for (uint64 c = 0; c < channels; c++) {
+					int64 b = (int64)(((*first)(c) - _lower) * scale);
+					if (b < 0) b = 0;
+					if (b >= (int64)bins) b = bins - 1;
+					_counts[c*bins + b]++;
+				}
+			}
+		}
+
+		void recursive_calculate(CollaborativeDescriptors& son1_descs, CollaborativeDescriptors& son2_descs, CollaborativeDescriptors* /*peer_descs*/) {
+			const VDHistogram& d1 = son1_descs.get(*this);
+			const VDHistogram& d2 = son2_descs.get(*this);
+			for (uint64 i = 0; i < channels*bins; i++) _counts[i] = d1._counts[i] + d2._counts[i];
+		}
+
+		DescriptorBase* clone() const {
+			return new VDHistogram(*this);
+		}
+
+		//! Sets the descriptor of a label from its statistics (see segmentation::LeafStatistics), which must have
+		//! the same number of bins. The range of the histogram is taken from the statistics.
+		template<class StatisticsModel>
+		void assign(const StatisticsModel& statistics, uint64 label) {
+			BOOST_STATIC_ASSERT(StatisticsModel::bins == bins);
+			_lower = statistics.histogram_lower();
+			_upper = statistics.histogram_upper();
+			for (uint64 c = 0; c < channels; c++) {
+				for (uint64 b = 0; b < bins; b++) _counts[c*bins + b] = statistics.histogram(label, c, b);
+			}
+		}
+
+		//! \return number of units of channel c in bin b
+		uint64 count(uint64 c, uint64 b) const {
+			return _counts[c*bins + b];
+		}
+
+	protected:
+
+		//! Slot of the histograms of a range: the one of the default range is looked up only once
+		static uint64 _slot_of(float64 lower, float64 upper) {
+			if (lower == 0 && upper == 256) return DescriptorRegistry::slot_of<VDHistogram>(type_id());
+			return DescriptorRegistry::slot(type_id(lower, upper));
+		}
+
+		float64 _lower;
+		float64 _upper;
+		boost::array<uint64, channels*bins> _counts;
+	};
+
+}
+
+#endif /* REGION_DESCRIPTORS_HPP_ */
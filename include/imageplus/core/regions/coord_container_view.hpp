@@ -0,0 +1,147 @@
+/*
+ * coord_container_view.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef COORD_CONTAINER_VIEW_HPP_
+#define COORD_CONTAINER_VIEW_HPP_
+
+#include <imageplus/core/imageplus_types.hpp>
+#include <vector>
+
+namespace imageplus {
+
+	//! Container of coordinates that views a range of an external array (e.g. the leaf coordinates of a
+	//! HierarchicalRegionPartition, sorted by label). Coordinates added with push_back are kept in an owned vector,
+	//! copying the viewed range first if needed.
+	template<class coord_model>
+	class CoordContainerView {
+	public:
+
+		typedef coord_model			coord_type;
+		typedef coord_type			value_type;
+		typedef coord_type*			iterator;
+		typedef const coord_type*	const_iterator;
+
+		//! Empty container
+		CoordContainerView() : _begin(NULL), _end(NULL) {
+		}
+
+		//! Container with n copies of a coordinate
+		//! \param[in] n : number of coordinates
+		//! \param[in] c : coordinate
+		CoordContainerView(uint64 n, const coord_type& c) : _own(n,c) {
+			_point_to_own();
+		}
+
+		//! Copy constructor. Views are copied as views, owned coordinates are copied.
+		//! \param[in] copy : container to copy
+		CoordContainerView(const CoordContainerView& copy) : _begin(copy._begin), _end(copy._end), _own(copy._own) {
+			if (!copy._own.empty()) _point_to_own();
+		}
+
+		//! Copy operator
+		//! \param[in] copy : container to copy
+		CoordContainerView& operator=(const CoordContainerView& copy) {
+			_own = copy._own;
+			_begin = copy._begin;
+			_end = copy._end;
+			if (!_own.empty()) _point_to_own();
+			return *this;
+		}
+
+		//! Views a range of coordinates, which must outlive the container
+		//! \param[in] first : first coordinate
+		//! \param[in] last : coordinate after the last one
+		void assign(coord_type* first, coord_type* last) {
+			_own.clear();
+			_begin = first;
+			_end = last;
+		}
+
+		//! Adds a coordinate
+		//! \param[in] c : coordinate
+		void push_back(const coord_type& c) {
+			if (_own.empty()) _own.assign(_begin, _end);
+			_own.push_back(c);
+			_point_to_own();
+		}
+
+		//! Number of coordinates
+		uint64 size() const {
+			return _end - _begin;
+		}
+
+		//! Removes all the coordinates (the viewed array is not modified)
+		void clear() {
+			_own.clear();
+			_begin = _end = NULL;
+		}
+
+		iterator begin() {
+			return _begin;
+		}
+
+		iterator end() {
+			return _end;
+		}
+
+		const_iterator begin() const {
+			return _begin;
+		}
+
+		const_iterator end() const {
+			return _end;
+		}
+
+	protected:
+
+		//! Views the owned coordinates
+		void _point_to_own() {
+			_begin = &_own[0];
+			_end = _begin + _own.size();
+		}
+
+		//! first coordinate
+		coord_type* _begin;
+
+		//! coordinate after the last one
+		coord_type* _end;
+
+		//! coordinates added to the container
+		std::vector<coord_type> _own;
+	};
+
+	//! Sets the coordinates of a container from a range
+	//! \param[out] container : container of coordinates
+	//! \param[in] first : first coordinate
+	//! \param[in] last : coordinate after the last one
+	template<class ContainerModel, class coord_type>
+	inline void assign_coordinates(ContainerModel& container, coord_type* first, coord_type* last) {
+		container.clear();
+		for (; first != last; ++first) container.push_back(*first);
+	}
+
+	//! Views the range (no copy)
+	template<class coord_type>
+	inline void assign_coordinates(CoordContainerView<coord_type>& container, coord_type* first, coord_type* last) {
+		container.assign(first, last);
+	}
+
+	//! Tells whether regions with a given coordinates container keep a copy of the coordinates of their children
+	template<class ContainerModel>
+	struct coords_container_traits {
+		static const bool copy_children = true;
+	};
+
+	//! Merged regions with viewed coordinates are only represented by their children
+	template<class coord_type>
+	struct coords_container_traits<CoordContainerView<coord_type> > {
+		static const bool copy_children = false;
+	};
+
+}
+
+#endif /* COORD_CONTAINER_VIEW_HPP_ */
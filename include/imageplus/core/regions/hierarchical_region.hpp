@@ -9,7 +9,9 @@
 #define HIERACHICAL_REGION_HPP_
 
 #include <vector>
+#include <imageplus/core/visual_descriptors.hpp>
 #include <imageplus/core/regions/region.hpp>
+#include <imageplus/core/regions/coord_container_view.hpp>
 #include <imageplus/core/regions/hierarchical_region_iterator.hpp>
 
 namespace imageplus
@@ -20,12 +22,16 @@ namespace imageplus
      * It can take advantage of a BPT to compute the descriptors recursively.
      * Assumes eigen vectors as coords, but can be changed
      *
-     * \author Jordi Pont Tuset - 05-05-2009 - Guillem Palou 2012
+     * By default the leaves view their coordinates in a shared array and merged regions only keep their children,
+     * so merging does not copy coordinates. With a container that copies the children (e.g. std::deque) the roots
+     * keep a copy of all their coordinates, as the leaves do.
+     *
+     * The descriptors of a merged region can be combined from the ones of its children (see calc_descriptor).
      *
-     * \todo Store the coordinates in sweeping order: Instead of a vector, use a sorted queue
+     * \author Jordi Pont Tuset - 05-05-2009 - Guillem Palou 2012
      */
-    template<class coord, class ContainerModel = typename Region<coord>::CoordsContainerType>
-    class HierarchicalRegion : public Region<coord, ContainerModel> {
+    template<class coord, class ContainerModel = CoordContainerView<coord>, class AllocationPolicy = HeapAllocation, class NeighborStorage = MapNeighborStorage>
+    class HierarchicalRegion : public Region<coord, ContainerModel, AllocationPolicy, NeighborStorage>, public collaborative_descriptors_traits {
     public:
     	static const uint64 dimensions = Region<coord>::dimensions;
 
@@ -34,10 +40,10 @@ namespace imageplus
         //! Pointer type of the region
         typedef HierarchicalRegion* 											RegionPointer;
         //! Type of Gerometric region (father)
-        typedef	Region<coord, ContainerModel>									RegionBaseType;
+        typedef	Region<coord, ContainerModel, AllocationPolicy, NeighborStorage>		RegionBaseType;
 
         //! this class type
-        typedef HierarchicalRegion<coord,ContainerModel>					 	RegionType;
+        typedef HierarchicalRegion<coord,ContainerModel,AllocationPolicy,NeighborStorage>	RegionType;
 
         //! iterator of the region coordinates
         typedef RegionIteratorBase<RegionType>									iterator;
@@ -93,7 +99,8 @@ namespace imageplus
          * Copy constructor
          * \param[in] copy : copy to construct
          */
-        inline HierarchicalRegion(const HierarchicalRegion& copy) : RegionBaseType(copy) {
+        //! The descriptors are not copied
+        inline HierarchicalRegion(const HierarchicalRegion& copy) : RegionBaseType(copy), collaborative_descriptors_traits() {
         	RegionBaseType::_label = copy.label();
         	_init(copy.children());
         	_parent = copy._parent;
@@ -234,6 +241,14 @@ namespace imageplus
         	return _children;
         }
 
+        /*!
+         * Returns the vector of children, as required by calc_descriptor
+         * \return the children
+         */
+        ChildrenContainerType& parts() {
+        	return _children;
+        }
+
         /*!
          * Returns a specific child
          * \param[in] child_num : the child to retrieve
@@ -276,11 +291,13 @@ namespace imageplus
                 child1->parent(this);
                 disp = child1->coordinates().size();
 
-                for (iterator it = child1->begin(); it != child1->end(); ++it) {
-                	RegionBaseType::coordinates().push_back(*it);
-                }
+                if (coords_container_traits<ContainerModel>::copy_children) {
+                	for (iterator it = child1->begin(); it != child1->end(); ++it) {
+                		RegionBaseType::coordinates().push_back(*it);
+                	}
 
-                if (child1->children().size() != 0) child1->coordinates().clear(); // we only maintain a copy of the coordinates at the roots and leaves
+                	if (child1->children().size() != 0) child1->coordinates().clear(); // we only maintain a copy of the coordinates at the roots and leaves
+                }
             }
 
             if(child2!=0)
@@ -288,11 +305,13 @@ namespace imageplus
                 this->_children.push_back(child2);
                 child2->parent(this);
 
-                for (iterator it = child2->begin(); it != child2->end(); ++it) {
-                	RegionBaseType::coordinates().push_back(*it);
-                }
+                if (coords_container_traits<ContainerModel>::copy_children) {
+                	for (iterator it = child2->begin(); it != child2->end(); ++it) {
+                		RegionBaseType::coordinates().push_back(*it);
+                	}
 
-                if (child2->children().size() != 0) child2->coordinates().clear(); // we only maintain a copy of the coordinates at the roots and leaves
+                	if (child2->children().size() != 0) child2->coordinates().clear(); // we only maintain a copy of the coordinates at the roots and leaves
+                }
              }
         }
 
@@ -307,11 +326,13 @@ namespace imageplus
 
         	for (typename ChildrenContainerType::iterator c = _children.begin(); c != _children.end(); ++c) {
 
-        		for (iterator it = (*c)->begin(); it != (*c)->end(); ++it) {
-        			RegionBaseType::coordinates().push_back(*it);
-        		}
+        		if (coords_container_traits<ContainerModel>::copy_children) {
+        			for (iterator it = (*c)->begin(); it != (*c)->end(); ++it) {
+        				RegionBaseType::coordinates().push_back(*it);
+        			}
 
-        		if ((*c)->children().size() != 0) (*c)->coordinates().clear(); // we only maintain a copy of the coordinates at the roots
+        			if ((*c)->children().size() != 0) (*c)->coordinates().clear(); // we only maintain a copy of the coordinates at the roots
+        		}
         		(*c)->parent(this);
         	}
         }
@@ -14,13 +14,17 @@
 #include <vector>
 
 #include <imageplus/core/regions/region_neighbor_container.hpp>
+#include <imageplus/core/regions/region_flat_neighbor_container.hpp>
 
 namespace imageplus {
 
 	//!
 	//! \brief Class to handle a geometric region, i.e., a vector of coordinates
 	//!
-	template<class coord, class ContainerModel = std::deque<coord> >
+	//! AllocationPolicy (HeapAllocation or ArenaAllocation) selects how the links to the neighbors are allocated,
+	//! and NeighborStorage (MapNeighborStorage or FlatNeighborStorage<>) the container of the neighbors
+	//!
+	template<class coord, class ContainerModel = std::deque<coord>, class AllocationPolicy = HeapAllocation, class NeighborStorage = MapNeighborStorage>
 	class Region
 	{
 	public:
@@ -34,8 +38,12 @@ namespace imageplus {
 		/*!< Type of container used  */
 		typedef         ContainerModel					         	CoordsContainerType;
 
+		//! allocation policy of regions and links
+		typedef AllocationPolicy									AllocationPolicyType;
+
 		//! neighbor container
-		typedef RegionNeighborContainer<Region*>					NeighborContainerType;
+		typedef typename NeighborStorage::template container<Region*, RegionDistanceLink<Region*>,
+				typename AllocationPolicy::template allocator<RegionDistanceLink<Region*> >::type>::type	NeighborContainerType;
 
 		typedef typename NeighborContainerType::RegionLinkType		RegionLinkType;
 
@@ -0,0 +1,162 @@
+/*
+ * region_allocators.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef REGION_ALLOCATORS_HPP_
+#define REGION_ALLOCATORS_HPP_
+
+#include <imageplus/core/imageplus_types.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <new>
+#include <vector>
+
+namespace imageplus {
+
+	//! Allocates every object on its own with the global operator new.
+	//! Objects are constructed with placement new on the memory returned by allocate().
+	template<class T>
+	class HeapAllocator {
+	public:
+
+		//! memory is returned object by object, so the objects alive at release() must be deallocated one by one
+		static const bool bulk_release = false;
+
+		//! Returns memory for one object
+		inline void* allocate() {
+			return ::operator new(sizeof(T));
+		}
+
+		//! Destroys an object and frees its memory
+		//! \param[in] p : object created on memory of this allocator
+		inline void deallocate(T* p) {
+			p->~T();
+			::operator delete(p);
+		}
+
+		//! Destroys an object and frees its memory (same as deallocate)
+		//! \param[in] p : object created on memory of this allocator
+		inline void destroy(T* p) {
+			deallocate(p);
+		}
+
+		//! Nothing to do, every object is freed in deallocate
+		inline void release() {
+		}
+
+		//! Allocator shared by the objects not attached to a particular one
+		static HeapAllocator& default_instance() {
+			static HeapAllocator instance;
+			return instance;
+		}
+	};
+
+	//! Allocates objects in blocks of block_size objects. Deallocated objects are reused, and release() frees
+	//! all the blocks at once without calling the destructors of the objects still alive. Objects owning other
+	//! resources are torn down with destroy(), which runs the destructor but leaves the memory to release().
+	template<class T, uint64 block_size = 4096>
+	class ArenaAllocator {
+	public:
+
+		//! all the memory is returned at once by release()
+		static const bool bulk_release = true;
+
+		//! Constructor
+		ArenaAllocator() : _used(block_size), _free(NULL) {
+		}
+
+		//! Destructor, frees all the blocks
+		~ArenaAllocator() {
+			release();
+		}
+
+		//! Returns memory for one object
+		inline void* allocate() {
+			if (_free != NULL) {
+				void* p = _free;
+				_free = *(void**)_free;
+				return p;
+			}
+			if (_used == block_size) {
+				_blocks.push_back((char*)::operator new(block_size*_stride()));
+				_used = 0;
+			}
+			return _blocks.back() + _stride()*(_used++);
+		}
+
+		//! Destroys an object and keeps its memory for the next allocation
+		//! \param[in] p : object created on memory of this allocator
+		inline void deallocate(T* p) {
+			p->~T();
+			*(void**)p = _free;
+			_free = p;
+		}
+
+		//! Destroys an object without recycling its memory, which is freed with the rest of the blocks by release()
+		//! \param[in] p : object created on memory of this allocator
+		inline void destroy(T* p) {
+			p->~T();
+		}
+
+		//! Frees all the blocks. Objects still alive are not destroyed.
+		void release() {
+			for (uint64 i = 0; i < _blocks.size(); i++) ::operator delete(_blocks[i]);
+			_blocks.clear();
+			_used = block_size;
+			_free = NULL;
+		}
+
+		//! Arena shared by the objects not attached to a particular one. It is created on first use and its blocks
+		//! are freed at program exit, so the objects allocated on it must not be used after main returns. It can
+		//! be released earlier with default_instance().release() once none of its objects is used anymore.
+		static ArenaAllocator& default_instance() {
+			static ArenaAllocator instance;
+			return instance;
+		}
+
+	protected:
+
+		//! ArenaAllocator is not copyable: copies would free the same blocks
+		ArenaAllocator(const ArenaAllocator&);
+
+		//! ArenaAllocator is not assignable: copies would free the same blocks
+		ArenaAllocator& operator=(const ArenaAllocator&);
+
+		//! Distance between two objects of a block (room for a free list pointer, aligned for T)
+		static inline uint64 _stride() {
+			const uint64 align = boost::alignment_of<T>::value;
+			const uint64 size = (sizeof(T) > sizeof(void*)) ? sizeof(T) : sizeof(void*);
+			return ((size + align - 1) / align) * align;
+		}
+
+		//! blocks of memory
+		std::vector<char*> _blocks;
+
+		//! objects used in the last block
+		uint64 _used;
+
+		//! list of deallocated objects
+		void* _free;
+	};
+
+	//! Policy allocating regions and links one by one with new and delete
+	struct HeapAllocation {
+		template<class T>
+		struct allocator {
+			typedef HeapAllocator<T> type;
+		};
+	};
+
+	//! Policy allocating regions and links in arenas freed in one shot by the partition
+	struct ArenaAllocation {
+		template<class T>
+		struct allocator {
+			typedef ArenaAllocator<T> type;
+		};
+	};
+
+}
+
+#endif /* REGION_ALLOCATORS_HPP_ */
@@ -0,0 +1,186 @@
+/*
+ * region_flat_neighbor_container.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef REGION_FLAT_NEIGHBOR_CONTAINER_HPP_
+#define REGION_FLAT_NEIGHBOR_CONTAINER_HPP_
+
+#include <imageplus/core/regions/region_links.hpp>
+#include <imageplus/core/regions/region_allocators.hpp>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace imageplus {
+
+	//! Container for the neighbor regions with the same interface as RegionNeighborContainer, backed by a small
+	//! unsorted array searched linearly. The first inline_size neighbors are stored inside the container, and the
+	//! neighbors of regions with more neighbors are moved to the heap.
+	//! Erasing a neighbor moves the last one to its place, so the iteration order is not the order of insertion.
+	template <class RegionModelPtr, class RegionLinkModel = RegionDistanceLink<RegionModelPtr>, class LinkAllocatorModel = HeapAllocator<RegionLinkModel>, uint64 inline_size = 8>
+	class RegionFlatNeighborContainer {
+
+		typedef RegionModelPtr								RegionPointer;
+		typedef std::pair<RegionPointer,RegionLinkModel*> 	neighbor_pair_type;
+
+	public:
+
+		typedef RegionLinkModel								RegionLinkType;
+
+		typedef LinkAllocatorModel							LinkAllocatorType;
+
+		RegionFlatNeighborContainer(RegionPointer r) : _region(r), _size(0), _link_allocator(&LinkAllocatorType::default_instance()) {
+
+		}
+
+		RegionFlatNeighborContainer(const RegionFlatNeighborContainer& copy, RegionPointer new_reg = NULL) : _region(copy._region), _size(copy._size), _heap(copy._heap), _link_allocator(copy._link_allocator) {
+			if (_heap.empty()) std::copy(copy._inline, copy._inline + _size, _inline);
+			if (new_reg != NULL) {
+				_region = new_reg;
+			}
+		}
+
+		class neighbor_iterator {
+		public:
+			neighbor_iterator() {
+			}
+
+			neighbor_iterator(neighbor_pair_type* it) : _it(it) {
+			}
+
+			bool operator==(const neighbor_iterator& it) {
+				return _it==it._it;
+			}
+
+			bool operator!=(const neighbor_iterator& it) {
+				return _it!=it._it;
+			}
+
+			RegionPointer operator*() const {
+				return _it->first;
+			}
+
+			RegionLinkType* link_data() const {
+				return _it->second;
+			}
+
+			neighbor_iterator& operator++() {
+				++_it;
+				return *this;
+			}
+
+		private:
+			neighbor_pair_type* _it;
+
+		};
+
+		//! Sets the allocator of the links created by this container
+		//! \param[in] allocator : allocator, which must outlive the links
+		void set_link_allocator(LinkAllocatorType* allocator) {
+			_link_allocator = allocator;
+		}
+
+		neighbor_iterator neighbors_begin() {
+			return neighbor_iterator(_data());
+		}
+
+		neighbor_iterator neighbors_end() {
+			return neighbor_iterator(_data() + _size);
+		}
+
+		neighbor_iterator neighbors_find(RegionPointer reg) {
+			return neighbor_iterator(_find(reg));
+		}
+
+		RegionLinkType* neighbors_insert(RegionPointer reg, RegionLinkType* link = NULL )
+		{
+			neighbor_pair_type* it = _find(reg);
+			if (it != _data() + _size) return it->second;
+
+			RegionLinkType* link_data = link;
+			if (link_data == NULL) {
+				link_data = new (_link_allocator->allocate()) RegionLinkType(_region, reg);
+				reg->neighbors().neighbors_insert(_region, link_data);
+			}
+
+			if (_heap.empty() && _size < inline_size) {
+				_inline[_size] = neighbor_pair_type(reg, link_data);
+			} else {
+				if (_heap.empty()) _heap.assign(_inline, _inline + _size);
+				_heap.push_back(neighbor_pair_type(reg, link_data));
+			}
+			_size++;
+
+			return link_data;
+		}
+
+		inline void neighbors_erase(RegionPointer reg, bool delete_link = true) {
+			neighbor_pair_type* it = _find(reg);
+
+			// We do this check to allow for merging of non-neighboring regions
+			if (it != _data() + _size) {
+				if (delete_link) {
+					_link_allocator->deallocate(it->second);
+					reg->neighbors().neighbors_erase(_region, false);
+				}
+				*it = _data()[_size-1];
+				_size--;
+				if (!_heap.empty()) _heap.pop_back();
+			}
+		}
+
+		inline void neighbors_clear() {
+			while (_size > 0) {
+				neighbors_erase(_data()[_size-1].first);
+			}
+			_heap.clear();
+		}
+
+	protected:
+
+		//! Array of the neighbors
+		inline neighbor_pair_type* _data() {
+			return _heap.empty() ? _inline : &_heap[0];
+		}
+
+		//! Linear search of a neighbor
+		inline neighbor_pair_type* _find(RegionPointer reg) {
+			neighbor_pair_type* it = _data();
+			neighbor_pair_type* end = it + _size;
+			for (; it != end; ++it) {
+				if (it->first == reg) break;
+			}
+			return it;
+		}
+
+		//! region where the container belongs
+		RegionPointer _region;
+
+		//! number of neighbors
+		uint64 _size;
+
+		//! first neighbors
+		neighbor_pair_type _inline[inline_size];
+
+		//! all the neighbors, once there are more than inline_size
+		std::vector<neighbor_pair_type> _heap;
+
+		//! allocator of the links
+		LinkAllocatorType* _link_allocator;
+	};
+
+	//! Neighbor storage policy of Region using RegionFlatNeighborContainer
+	template<uint64 inline_size = 8>
+	struct FlatNeighborStorage {
+		template<class RegionPtr, class RegionLinkModel, class LinkAllocatorModel>
+		struct container {
+			typedef RegionFlatNeighborContainer<RegionPtr, RegionLinkModel, LinkAllocatorModel, inline_size> type;
+		};
+	};
+
+}
+
+#endif /* REGION_FLAT_NEIGHBOR_CONTAINER_HPP_ */
@@ -9,14 +9,16 @@
 #define REGION_NEIGHBOR_CONTAINER_HPP_
 
 #include <imageplus/core/regions/region_links.hpp>
+#include <imageplus/core/regions/region_allocators.hpp>
 #include <map>
 
 #include <iostream>
 
 namespace imageplus {
 
-	//! Basic container for the neighbor regions
-	template <class RegionModelPtr, class RegionLinkModel = RegionDistanceLink<RegionModelPtr> >
+	//! Basic container for the neighbor regions.
+	//! Links are created and destroyed with a LinkAllocatorModel (see region_allocators.hpp) shared by both regions of a link.
+	template <class RegionModelPtr, class RegionLinkModel = RegionDistanceLink<RegionModelPtr>, class LinkAllocatorModel = HeapAllocator<RegionLinkModel> >
 	class RegionNeighborContainer {
 
 		typedef RegionModelPtr								RegionPointer;
@@ -27,11 +29,13 @@ namespace imageplus {
 
 		typedef RegionLinkModel								RegionLinkType;
 
-		RegionNeighborContainer(RegionPointer r) : _region(r) {
+		typedef LinkAllocatorModel							LinkAllocatorType;
+
+		RegionNeighborContainer(RegionPointer r) : _region(r), _link_allocator(&LinkAllocatorType::default_instance()) {
 
 		}
 
-		RegionNeighborContainer(const RegionNeighborContainer& copy, RegionPointer new_reg = NULL) : _region(copy._region), _neighbors(copy._neighbors){
+		RegionNeighborContainer(const RegionNeighborContainer& copy, RegionPointer new_reg = NULL) : _region(copy._region), _neighbors(copy._neighbors), _link_allocator(copy._link_allocator) {
 			if (new_reg != NULL) {
 				_region = new_reg;
 			}
@@ -71,6 +75,12 @@ namespace imageplus {
 
 		};
 
+		//! Sets the allocator of the links created by this container
+		//! \param[in] allocator : allocator, which must outlive the links
+		void set_link_allocator(LinkAllocatorType* allocator) {
+			_link_allocator = allocator;
+		}
+
 		neighbor_iterator neighbors_begin() {
 			return neighbor_iterator(_neighbors.begin());
 		}
@@ -93,7 +103,7 @@ namespace imageplus {
 			{
 				RegionLinkType* link_data;
 				if (link == NULL) {
-					link_data = new RegionLinkType(_region, reg);
+					link_data = new (_link_allocator->allocate()) RegionLinkType(_region, reg);
 					reg->neighbors().neighbors_insert(_region, link_data);
 				}
 				else
@@ -111,7 +121,7 @@ namespace imageplus {
 			// We do this check to allow for merging of non-neighboring regions
 			if(neigh_it != this->neighbors_end()) {
 				if (delete_link) {
-					delete neigh_it.link_data();
+					_link_allocator->deallocate(neigh_it.link_data());
 					reg->neighbors().neighbors_erase(_region, false);
 				}
 				_neighbors.erase(reg);
@@ -119,9 +129,9 @@ namespace imageplus {
 		}
 
 		inline void neighbors_clear() {
-			neighbor_iterator neigh_it = this->neighbors_begin();
-			for(; neigh_it!=this->neighbors_end(); ++neigh_it) {
-				neighbors_erase(*neigh_it);
+			// erasing invalidates the iterator to the erased neighbor
+			while (!_neighbors.empty()) {
+				neighbors_erase(_neighbors.begin()->first);
 			}
 		}
 
@@ -132,8 +142,18 @@ namespace imageplus {
 
 		//! Pointer to the neighbor regions
 		neighbor_map_type _neighbors;
+
+		//! allocator of the links
+		LinkAllocatorType* _link_allocator;
 	};
 
+	//! Neighbor storage policy of Region using RegionNeighborContainer
+	struct MapNeighborStorage {
+		template<class RegionPtr, class RegionLinkModel, class LinkAllocatorModel>
+		struct container {
+			typedef RegionNeighborContainer<RegionPtr, RegionLinkModel, LinkAllocatorModel> type;
+		};
+	};
 
 }
 
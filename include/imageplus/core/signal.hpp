@@ -16,7 +16,9 @@
 #include <imageplus/core/imageplus_types.hpp>
 
 #include <imageplus/core/iterators/global_iterator.hpp>
+#include <imageplus/core/iterators/span_iterator.hpp>
 #include <imageplus/core/iterators/adjacency_iterator.hpp>
+#include <imageplus/core/iterators/adjacency_scan.hpp>
 #include <imageplus/core/iterators/region_iterator.hpp>
 #include <imageplus/core/iterators/roi_iterator.hpp>
 
@@ -25,7 +27,8 @@
 namespace imageplus {
 
 	//! Class for a discrete space signal
-	template<typename domain_coords_type, typename codomain_coords_type, uint64 domain_dimensions, uint64 codomain_dimensions>
+	//! Layout selects the memory layout of the values (see SignalContainer): interleaved by default.
+	template<typename domain_coords_type, typename codomain_coords_type, uint64 domain_dimensions, uint64 codomain_dimensions, class Layout = InterleavedLayout>
 	class Signal {
 	public:
 
@@ -56,17 +59,44 @@ namespace imageplus {
 
 
 		//! this class
-		typedef Signal<domain_coords_type, codomain_coords_type, domain_dimensions, codomain_dimensions> 			ThisClassType;
+		typedef Signal<domain_coords_type, codomain_coords_type, domain_dimensions, codomain_dimensions, Layout> 	ThisClassType;
 
 		//! Container type for this kind of signal
-		typedef SignalContainer<coord_type,value_type>																ContainerType;
+		typedef SignalContainer<coord_type,value_type,Layout>														ContainerType;
+
+		//! Memory layout of the values
+		typedef Layout																								layout_type;
+
+		//! Views of the values of a unit
+		typedef typename ContainerType::unit_map_type																unit_map_type;
+
+		//! distance between two consecutive units of a row
+		static const uint64				unit_stride = ContainerType::unit_stride;
+
+		//! true if data() is a dense array of sizes().prod() units with interleaved values
+		static const bool				packed = ContainerType::packed;
 
 		//! Value of the return type (normally an eigen map)
 		typedef typename ContainerType::value_ret_type																value_ret_type;
 
+		//! Value of the return type for reading (normally an eigen map of constant values)
+		typedef typename ContainerType::value_const_ret_type														value_const_ret_type;
+
 		//! global signal iterator
 		typedef global_iterator_type<ThisClassType>																	iterator;
 
+		//! span (row) signal iterator
+		typedef span_iterator_type<ThisClassType>																	span_iterator;
+
+		//! span returned by the span iterator
+		typedef signal_span<ThisClassType>																			span_type;
+
+		//! read-only span (row) signal iterator
+		typedef span_iterator_type<ThisClassType,true>																const_span_iterator;
+
+		//! span returned by the read-only span iterator
+		typedef signal_span<ThisClassType,true>																		const_span_type;
+
 		//! global signal iterator
 		typedef roi_iterator_type<ThisClassType>																	roi_iterator;
 
@@ -103,11 +133,18 @@ namespace imageplus {
 			_sizes = _upper_point - _lower_point + coord_type::Ones();
 		}
 
-		//! Copy constructor
-		//! \param[in] copy : signal to be copied. Notice that for the container, the space pointer should change from copy._space
-		Signal(Signal& copy) : _sizes(copy._sizes), _lower_point(copy._lower_point), _upper_point(copy._upper_point), _data(copy._sizes,copy.data()) {
+		//! Copy constructor, in O(1): the data is shared until one of the signals is written (see SignalContainer)
+		//! \param[in] copy : signal to be copied
+		Signal(Signal& copy) : _sizes(copy._sizes), _lower_point(copy._lower_point), _upper_point(copy._upper_point), _data(copy._data) {
 		}
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		//! Move constructor, takes the data of copy
+		//! \param[in] copy : signal to be moved
+		Signal(Signal&& copy) : _sizes(copy._sizes), _lower_point(copy._lower_point), _upper_point(copy._upper_point), _data(std::move(copy._data)) {
+		}
+#endif
+
 		//! Constructor with a pointer to the data
 		//! \param[in] size : size of the buffer
 		//! \param[in] data :  pointer to the buffer
@@ -124,10 +161,21 @@ namespace imageplus {
 			_lower_point = copy._lower_point;
 			_upper_point = copy._upper_point;
 
-			// call the copy constructor for the container
+			// shares the data of the container
 			_data = copy._data;
 		}
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		//! Move assignment, takes the data of copy
+		//! \param[in] copy : signal to be moved
+		void operator=(Signal&& copy) {
+			_sizes = copy._sizes;
+			_lower_point = copy._lower_point;
+			_upper_point = copy._upper_point;
+			_data = std::move(copy._data);
+		}
+#endif
+
 		//! Implemented functions to retrieve a unit coordinate
 		//! \param[in] coord : coordinate of the unit
 		//! \return unit at pos coord
@@ -156,7 +204,7 @@ namespace imageplus {
 		//! \param[in] coord : coordinate of the unit
 		//! \return unit at pos coord
 		inline value_ret_type value_at_coord(const coord_type& coord) {
-			return _data.value_at_coord(coord);
+			return _data.map(_data.value_at_coord(coord));
 		}
 
 		//! Implemented functions to retrieve a unit coordinate for 2D coords
@@ -164,8 +212,7 @@ namespace imageplus {
 		//! \param[in] y : y coordinate of the unit
 		//! \return unit at pos (x,y)
 		inline value_ret_type value_at_coord(domain_coords_type x, domain_coords_type y) {
-			coord_type coord(x,y);
-			return _data.value_at_coord(coord);
+			return _data.map(_data.value_at_coord(x,y));
 		}
 
 		//! Implemented functions to retrieve a unit coordinate for 3D coords
@@ -174,8 +221,25 @@ namespace imageplus {
 		//! \param[in] z : z coordinate of the unit
 		//! \return unit at pos (x,y)
 		inline value_ret_type value_at_coord(domain_coords_type x, domain_coords_type y, domain_coords_type z) {
-			coord_type coord(x,y,z);
-			return _data.value_at_coord(coord);
+			return _data.map(_data.value_at_coord(x,y,z));
+		}
+
+		//! Retrieves a unit for reading. Unlike the non-const accessors, it never copies data shared with other
+		//! signals (see SignalContainer), so it is the cheap way to read a copied signal.
+		//! \param[in] coord : coordinate of the unit
+		//! \return unit at pos coord
+		inline value_const_ret_type operator()(const coord_type& coord) const {
+			return _data.map(_data.value_at_coord(coord));
+		}
+
+		//! Retrieves a unit for reading, for 2D coords
+		inline value_const_ret_type operator()(domain_coords_type x, domain_coords_type y) const {
+			return _data.map(_data.value_at_coord(x,y));
+		}
+
+		//! Retrieves a unit for reading, for 3D coords
+		inline value_const_ret_type operator()(domain_coords_type x, domain_coords_type y, domain_coords_type z) const {
+			return _data.map(_data.value_at_coord(x,y,z));
 		}
 
 	//Sizes method
@@ -183,41 +247,41 @@ namespace imageplus {
 
 		//! Returns the sizes for every dimensions
 		//! \return vector
-		const coord_type& sizes() {
+		const coord_type& sizes() const {
 			return _sizes;
 		}
 
 		//! Returns the size for the first dimension
 		//! \return x size
-		coord_data_type size_x() {
+		coord_data_type size_x() const {
 			return _sizes(0);
 		}
 
 		//! Returns the size for the second dimension
 		//! \return y size
-		coord_data_type size_y() {
+		coord_data_type size_y() const {
 			return _sizes(1);
 		}
 
 		//! Returns the size for the third dimension
 		//! \return z size
-		coord_data_type size_z() {
+		coord_data_type size_z() const {
 			return _sizes(2);
 		}
 
 		//! Returns the lower point
 		//! \return the lower point
-		const coord_type& lower_point() {
+		const coord_type& lower_point() const {
 			return _lower_point;
 		}
 
 		//! Returns the upper point
 		//! \return the upper point
-		const coord_type& upper_point() {
+		const coord_type& upper_point() const {
 			return _upper_point;
 		}
 
-		bool inside(const coord_type& x) {
+		bool inside(const coord_type& x) const {
 			coord_type a = x - lower_point();
 			coord_type b = upper_point() - x;
 			if (a.minCoeff() < 0 || b.minCoeff() < 0) {
@@ -226,7 +290,7 @@ namespace imageplus {
 			return true;
 		}
 
-		bool inside(const coord_float_type& x) {
+		bool inside(const coord_float_type& x) const {
 			coord_float_type a = x - _lower_point.template cast<float64>();
 			coord_float_type b = _upper_point.template cast<float64>() - x;
 			if (a.minCoeff() < 0 || b.minCoeff() < 0) {
@@ -244,11 +308,37 @@ namespace imageplus {
 			_data.init_data(sizes);
 		}
 
-		//! Returns the pointer to the data
+		//! Uses a buffer owned by another object (e.g. a cv::Mat) as the data of the signal, without copying it
+		//! \param[in] sizes: size of the space
+		//! \param[in] data: buffer, with the memory layout of the signal
+		//! \param[in] keeper: reference to the owner of the buffer, kept while any signal shares the data
+		void adopt_data(const coord_type& sizes, value_data_type* data, const boost::shared_ptr<void>& keeper) {
+			_sizes = sizes;
+			_lower_point = coord_type::Zero();
+			_upper_point = sizes - coord_type::Ones();
+			_data.adopt_data(sizes, data, keeper);
+		}
+
+		//! Returns the pointer to the data, for writing
 		value_data_type* data() {
 			return _data.data();
 		}
 
+		//! Returns the pointer to the data, for reading (shared data is not copied)
+		const value_data_type* data() const {
+			return _data.data();
+		}
+
+		//! Returns the distance between the values of the units in every dimension (see SignalContainer::strides)
+		const coord_type& strides() const {
+			return _data.strides();
+		}
+
+		//! Returns the distance between two channels of a unit (1 for interleaved layouts)
+		int64 channel_stride() const {
+			return _data.channel_stride();
+		}
+
 		//! Returns the pointer to the data
 		//! \param[in] offset: offset to the initial position
 		value_data_type* data(const coord_type& offset) {
@@ -276,6 +366,34 @@ namespace imageplus {
 			return iterator(this,false,order);
 		}
 
+	//span iterator
+	public:
+
+		//! iterator for the whole signal, returning contiguous runs of the first dimension
+		//! \returns begin to the signal spans
+		span_iterator span_begin() {
+			return span_iterator(this,false);
+		}
+
+		//! iterator for the whole signal, returning contiguous runs of the first dimension
+		//! \returns the end of the signal spans
+		span_iterator span_end() {
+			return span_iterator(this,true);
+		}
+
+		//! read-only iterator for the whole signal, returning contiguous runs of the first dimension. It reads the
+		//! data through the const data(), so shared data is not copied.
+		//! \returns begin to the signal spans
+		const_span_iterator span_begin() const {
+			return const_span_iterator(this,false);
+		}
+
+		//! read-only iterator for the whole signal, returning contiguous runs of the first dimension
+		//! \returns the end of the signal spans
+		const_span_iterator span_end() const {
+			return const_span_iterator(this,true);
+		}
+
 	//adjacency iterator
 	public:
 
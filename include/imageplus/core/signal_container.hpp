@@ -9,13 +9,126 @@
 #define DISCRETE_SPACE_SIGNAL_CONTAINER_HPP_
 
 #include <imageplus/math/math_types.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/checked_delete.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/static_assert.hpp>
+#include <algorithm>
 #include <iostream>
+#include <utility>
 
 namespace imageplus {
 
+	//! Memory layout of the values of a signal: interleaved (the channels of a unit are contiguous), with the rows
+	//! (spans of the first dimension) packed one after the other. This is the default layout, and the only one in
+	//! which data() is a dense array of sizes().prod()*value_dimensions values (see SignalContainer::packed).
+	struct InterleavedLayout {
+		static const bool planar = false;
+		static const uint64 row_alignment = 0;
+	};
+
+	//! Interleaved values, with every row starting at a multiple of alignment bytes (e.g. 32 or 64, for aligned vector
+	//! loads), padding the end of the rows if needed
+	template<uint64 alignment>
+	struct AlignedInterleavedLayout {
+		static const bool planar = false;
+		static const uint64 row_alignment = alignment;
+	};
+
+	//! Planar values: every channel is stored in its own plane, laid out as a signal of one channel. The rows start
+	//! at multiples of alignment bytes (0 packs them) and the planes at multiples of 64 bytes.
+	template<uint64 alignment = 0>
+	struct PlanarLayout {
+		static const bool planar = true;
+		static const uint64 row_alignment = alignment;
+	};
+
+	//! View of the values of a unit, given the pointer to its first channel and the distance between channels
+	template<bool planar, class value_type>
+	struct unit_map_traits {
+		typedef Eigen::Map<value_type>					type;
+		typedef Eigen::Map<const value_type>			const_type;
+
+		template<class MapType, class Pointer>
+		static inline MapType make(Pointer p, int64 /*channel_stride*/) {
+			return MapType(p);
+		}
+	};
+
+	//! View of the values of a unit of a planar signal
+	template<class value_type>
+	struct unit_map_traits<true, value_type> {
+		typedef Eigen::Map<value_type, 0, Eigen::InnerStride<> >			type;
+		typedef Eigen::Map<const value_type, 0, Eigen::InnerStride<> >		const_type;
+
+		template<class MapType, class Pointer>
+		static inline MapType make(Pointer p, int64 channel_stride) {
+			return MapType(p, Eigen::InnerStride<>(channel_stride));
+		}
+	};
+
+	//! Memory displacement of a coordinate given the weight vector of a container.
+	//! The first weight is always the distance between two units of a row, so it is known at compile time. The
+	//! others depend on the sizes of the signal, so they are read from the weight vector.
+	//! Specialized (unrolled) for 1, 2 and 3 dimensions.
+	template<uint64 coord_dimensions, uint64 unit_stride>
+	struct strided_offset {
+		template<class coord_type>
+		static inline int64 compute(const coord_type& w, const coord_type& coord) {
+			return (w.transpose()*coord).sum();
+		}
+	};
+
+	//! Memory displacement for 1D coordinates
+	template<uint64 unit_stride>
+	struct strided_offset<1, unit_stride> {
+		template<class coord_type>
+		static inline int64 compute(const coord_type& /*w*/, const coord_type& coord) {
+			return unit_stride*coord(0);
+		}
+	};
+
+	//! Memory displacement for 2D coordinates
+	template<uint64 unit_stride>
+	struct strided_offset<2, unit_stride> {
+		template<class coord_type>
+		static inline int64 compute(const coord_type& w, const coord_type& coord) {
+			return unit_stride*coord(0) + w(1)*coord(1);
+		}
+	};
+
+	//! Memory displacement for 3D coordinates
+	template<uint64 unit_stride>
+	struct strided_offset<3, unit_stride> {
+		template<class coord_type>
+		static inline int64 compute(const coord_type& w, const coord_type& coord) {
+			return unit_stride*coord(0) + w(1)*coord(1) + w(2)*coord(2);
+		}
+	};
+
+	//! Number of bytes copied by the containers when they make shared data unique (see SignalContainer)
+	inline boost::atomic<uint64>& signal_bytes_copied() {
+		static boost::atomic<uint64> bytes(0);
+		return bytes;
+	}
+
 	//! Base class for the container of a Discrete Space Signal
+	//!
+	//! The data is reference counted and copied on write: copies of a container share its buffer in O(1), and the
+	//! buffer is copied only when a container sharing it is accessed for writing (data(), value_at_coord()), so
+	//! every container sees its own values. Pointers obtained before the container is copied keep pointing to the
+	//! shared buffer. The reference count is thread safe, but making the data unique is not: data shared with other
+	//! containers must be made unique (e.g. calling data()) before several threads access it, and copying a container
+	//! marks the source as shared, so it must not be accessed by other threads meanwhile.
+	//!
+	//! Containers built on a buffer they do not own (views, e.g. a frame of a video) never copy it: their copies
+	//! are views of the same buffer, and assigning a view to a container copies the values.
+	//!
+	//! The buffers allocated by the container start at a multiple of 64 bytes. Layout selects how the values are
+	//! placed in them (InterleavedLayout, AlignedInterleavedLayout or PlanarLayout).
 	// The SignalPtr should be a pointer
-	template<typename domain_coord_type, typename codomain_coord_type>
+	template<typename domain_coord_type, typename codomain_coord_type, class Layout = InterleavedLayout>
 	class SignalContainer {
 
 	public:
@@ -35,14 +148,35 @@ namespace imageplus {
 		//! Value type
 		typedef codomain_coord_type						value_type;
 
+		//! Memory layout
+		typedef Layout									layout_type;
+
+		//! Views of the values of a unit
+		typedef unit_map_traits<Layout::planar, value_type>	unit_map_type;
+
 		//! Value returned type
-		typedef Eigen::Map<value_type>					value_ret_type;
+		typedef typename unit_map_type::type			value_ret_type;
+
+		//! Value returned type, for reading
+		typedef typename unit_map_type::const_type		value_const_ret_type;
 
 		//! Value data type (int,float...)
 		typedef typename value_type::Scalar				value_data_type;
 
+		//! distance between two consecutive units of a row
+		static const uint64 unit_stride = Layout::planar ? 1 : value_dimensions;
+
+		//! true if the data is a dense array of units with interleaved values, without padding
+		static const bool packed = (!Layout::planar || value_dimensions == 1) && Layout::row_alignment == 0;
+
+		//! alignment in bytes of the allocated buffers (and of the planes of planar layouts)
+		static const uint64 buffer_alignment = 64;
+
+		//! Displacement computation for this container
+		typedef strided_offset<coord_dimensions, unit_stride>	offset_type;
+
 		//! Default constructor
-		SignalContainer() :  _data(NULL) {
+		SignalContainer() : _origin(0), _channel_stride(1), _data(NULL), _maybe_shared(false) {
 
 		}
 
@@ -53,8 +187,8 @@ namespace imageplus {
 			_sizes = upper_point - lower_point;
 			_lower_point = lower_point;
 			_upper_point = upper_point;
-			_owner = true;
 			_init();
+			_allocate();
 		}
 
 		//! Constructor specifying sizes for the discrete space
@@ -64,11 +198,11 @@ namespace imageplus {
 			_lower_point = coord_type();
 			_lower_point.fill(0);
 			_upper_point = size;
-			_owner = true;
 			_init();
+			_allocate();
 		}
 
-		//! Constructor specifying sizes for the discrete space
+		//! Constructor specifying sizes for the discrete space, viewing a buffer owned by someone else
 		//! \param[in] size : vector containing each dimensions size
 		//! \param[in] data : buffer to the data
 		SignalContainer(const coord_type& size, value_data_type* data) {
@@ -76,67 +210,203 @@ namespace imageplus {
 			_lower_point = coord_type();
 			_lower_point.fill(0);
 			_upper_point = size;
-			_owner = false;
 			_data = data;
+			_maybe_shared = false;
+			_init();
+		}
+
+		//! Constructor adopting a buffer owned by another object (e.g. a cv::Mat)
+		//! \param[in] size : vector containing each dimensions size
+		//! \param[in] data : buffer to the data
+		//! \param[in] keeper : reference to the owner of the buffer, released when the last container sharing it is destroyed
+		SignalContainer(const coord_type& size, value_data_type* data, const boost::shared_ptr<void>& keeper) {
+			_sizes = size;
+			_lower_point = coord_type();
+			_lower_point.fill(0);
+			_upper_point = size;
+			_data = data;
+			_keeper = keeper;
+			_maybe_shared = true;
 			_init();
 		}
 
-		//! Copy constructor.
-		//! Be careful! The space pointer should change if this copy constructor is called from a DiscreteSpaceSignal copy constructor
+		//! Copy constructor, shares the data of copy until one of them is written
 		//! \param[in] copy : container to copy
-		SignalContainer(const SignalContainer& copy) : _sizes(copy._sizes), _w(copy._w), _lower_point(copy._lower_point), _upper_point(copy._upper_point) {
-			_owner = false;
-			_data = copy._data;
-			//_init();
-			//_copy_data(copy);
+		SignalContainer(const SignalContainer& copy) : _sizes(copy._sizes), _w(copy._w), _lower_point(copy._lower_point), _upper_point(copy._upper_point), _origin(copy._origin), _channel_stride(copy._channel_stride), _data(copy._data), _keeper(copy._keeper), _maybe_shared(true) {
+			copy._maybe_shared = true;
 		}
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		//! Move constructor, takes the data of copy, which is left empty
+		//! \param[in] copy : container to move
+		SignalContainer(SignalContainer&& copy) : _sizes(copy._sizes), _w(copy._w), _lower_point(copy._lower_point), _upper_point(copy._upper_point), _origin(copy._origin), _channel_stride(copy._channel_stride), _data(copy._data), _keeper(std::move(copy._keeper)), _maybe_shared(copy._maybe_shared) {
+			copy._data = NULL;
+			copy._maybe_shared = false;
+		}
+#endif
+
 		//! Default destructor
 		~SignalContainer() {
-			if (_owner) delete _data;
-			//delete _units;
 		}
 
+		//! Shares the data of copy until one of them is written. If copy is a view, its values are copied.
+		//! \param[in] copy : container to copy
 		void operator=(const SignalContainer& copy) {
-			if (_owner) delete _data;
+			if (this == &copy) return;
 			_sizes = copy._sizes;
 			_w = copy._w;
 			_lower_point = copy._lower_point;
 			_upper_point = copy._upper_point;
-			_owner = true;
-			_init();
-			_copy_data(copy);
+			_origin = copy._origin;
+			_channel_stride = copy._channel_stride;
+			if (copy._keeper) {
+				_data = copy._data;
+				_keeper = copy._keeper;
+				_maybe_shared = true;
+				copy._maybe_shared = true;
+			} else {
+				_allocate();
+				_copy_data(copy._data);
+			}
 		}
 
-		//SignalContainer clone() {
-			//_init();
-		//}
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		//! Takes the data of copy, which is left empty. If copy is a view, its values are copied.
+		//! \param[in] copy : container to move
+		void operator=(SignalContainer&& copy) {
+			if (this == &copy) return;
+			if (!copy._keeper) {
+				operator=(static_cast<const SignalContainer&>(copy));
+				return;
+			}
+			_sizes = copy._sizes;
+			_w = copy._w;
+			_lower_point = copy._lower_point;
+			_upper_point = copy._upper_point;
+			_origin = copy._origin;
+			_channel_stride = copy._channel_stride;
+			_data = copy._data;
+			_keeper = std::move(copy._keeper);
+			_maybe_shared = copy._maybe_shared;
+			copy._data = NULL;
+			copy._maybe_shared = false;
+		}
+#endif
+
+		//! Function returning the address of a given coordinate in the discrete space, for writing
+		//! \param[in] coord : coordinate of the space
+		//! \return memory address of the data
+		inline value_data_type* value_at_coord(const coord_type& coord) {
+			_make_unique();
+			return _data + (_origin + offset_type::compute(_w, coord));
+		}
+
+		//! Function returning the address of a given 2D coordinate in the discrete space, for writing
+		//! \param[in] x : x coordinate
+		//! \param[in] y : y coordinate
+		//! \return memory address of the data
+		inline value_data_type* value_at_coord(coord_data_type x, coord_data_type y) {
+			BOOST_STATIC_ASSERT(coord_dimensions == 2);
+			_make_unique();
+			return _data + (_origin + static_cast<int64>(unit_stride)*x + _w(1)*y);
+		}
 
-		//! Function returning the address of a given coordinate in the discrete space
+		//! Function returning the address of a given 3D coordinate in the discrete space, for writing
+		//! \param[in] x : x coordinate
+		//! \param[in] y : y coordinate
+		//! \param[in] z : z coordinate
+		//! \return memory address of the data
+		inline value_data_type* value_at_coord(coord_data_type x, coord_data_type y, coord_data_type z) {
+			BOOST_STATIC_ASSERT(coord_dimensions == 3);
+			_make_unique();
+			return _data + (_origin + static_cast<int64>(unit_stride)*x + _w(1)*y + _w(2)*z);
+		}
+
+		//! Function returning the address of a given coordinate in the discrete space, for reading
 		//! \param[in] coord : coordinate of the space
 		//! \return memory address of the data
-		inline value_data_type* value_at_coord(const coord_type& coord) const {
-			uint64 disp = (_w.transpose()*(coord-_lower_point)).sum();
-			return _data+disp;
+		inline const value_data_type* value_at_coord(const coord_type& coord) const {
+			return _data + (_origin + offset_type::compute(_w, coord));
+		}
+
+		//! Function returning the address of a given 2D coordinate in the discrete space, for reading
+		inline const value_data_type* value_at_coord(coord_data_type x, coord_data_type y) const {
+			BOOST_STATIC_ASSERT(coord_dimensions == 2);
+			return _data + (_origin + static_cast<int64>(unit_stride)*x + _w(1)*y);
 		}
 
-		//! return a pointer to the data
+		//! Function returning the address of a given 3D coordinate in the discrete space, for reading
+		inline const value_data_type* value_at_coord(coord_data_type x, coord_data_type y, coord_data_type z) const {
+			BOOST_STATIC_ASSERT(coord_dimensions == 3);
+			return _data + (_origin + static_cast<int64>(unit_stride)*x + _w(1)*y + _w(2)*z);
+		}
+
+		//! View of the values of a unit
+		//! \param[in] unit : pointer to the first channel of the unit (e.g. from value_at_coord)
+		inline value_ret_type map(value_data_type* unit) const {
+			return unit_map_type::template make<value_ret_type>(unit, _channel_stride);
+		}
+
+		//! View of the values of a unit, for reading
+		//! \param[in] unit : pointer to the first channel of the unit (e.g. from value_at_coord)
+		inline value_const_ret_type map(const value_data_type* unit) const {
+			return unit_map_type::template make<value_const_ret_type>(unit, _channel_stride);
+		}
+
+		//! \return distance between the values of the units in every dimension (the first one is unit_stride, the
+		//! second one is the distance between two rows)
+		const coord_type& strides() const {
+			return _w;
+		}
+
+		//! \return distance between two channels of a unit (1 for interleaved layouts)
+		int64 channel_stride() const {
+			return _channel_stride;
+		}
+
+		//! return a pointer to the data, for writing
 		//! \return pointer
 		value_data_type* data(const coord_type& offset) {
-			uint64 disp = (_w.transpose()*(offset-_lower_point)).sum();
-			return _data+disp;
+			return value_at_coord(offset);
 		}
 
-		//! return a pointer to the data
+		//! return a pointer to the data, for writing
 		//! \return pointer
 		value_data_type* data() {
+			_make_unique();
+			return _data;
+		}
+
+		//! return a pointer to the data, for reading (the data is not made unique)
+		//! \return pointer
+		const value_data_type* data() const {
 			return _data;
 		}
 
+		//! \return whether the data is shared with other containers
+		bool is_shared() const {
+			return _keeper.use_count() > 1;
+		}
+
 		//! inits the data if something is read
 		void init_data(const coord_type& size) {
-			if (_data != NULL) delete _data;
-			_owner = true;
+			_sizes = size;
+			_lower_point = coord_type();
+			_lower_point.fill(0);
+			_upper_point = size;
+			_init();
+			_allocate();
+		}
+
+		//! Adopts a buffer owned by another object instead of allocating one. The buffer is shared, not copied,
+		//! so it must have the memory layout of the container (interleaved values, dimension 0 first).
+		//! \param[in] size : vector containing each dimensions size
+		//! \param[in] data : buffer to the data
+		//! \param[in] keeper : reference to the owner of the buffer, released when the last container sharing it is destroyed
+		void adopt_data(const coord_type& size, value_data_type* data, const boost::shared_ptr<void>& keeper) {
+			_data = data;
+			_keeper = keeper;
+			_maybe_shared = true;
 			_sizes = size;
 			_lower_point = coord_type();
 			_lower_point.fill(0);
@@ -146,27 +416,68 @@ namespace imageplus {
 
 	private:
 
-		//! Function called to init the container. Sets the sizes, and the memory storage order
+		//! Rounds a number of values up to a multiple of an alignment in bytes (0 does not round)
+		static inline uint64 _round_up(uint64 values, uint64 alignment) {
+			uint64 step = alignment / sizeof(value_data_type);
+			if (step <= 1) return values;
+			return (values + step - 1) / step * step;
+		}
+
+		//! Function called to init the container. Sets the memory storage order
 		void _init() {
 
 			_w = coord_type();
-			_w(0) = value_dimensions;
+			_w(0) = unit_stride;
 			for (uint64 i = 1; i < coord_dimensions; i++) {
 				_w(i) = _w(i-1)*_sizes(i-1);
+				if (i == 1) _w(i) = _round_up(_w(i), Layout::row_alignment);
 			}
 
-			uint64 N = _sizes.prod();
+			// values of one channel (a plane for planar layouts)
+			uint64 plane = (coord_dimensions == 1) ? unit_stride*_sizes(0) : _w(coord_dimensions-1)*_sizes(coord_dimensions-1);
+			_channel_stride = Layout::planar ? _round_up(plane, buffer_alignment) : 1;
 
-			if (_owner)
-				_data = new value_data_type[N*value_dimensions]();
+			// the lower point is folded into a constant displacement, so accesses do not subtract it
+			_origin = -offset_type::compute(_w, _lower_point);
 		}
 
-		//! Used to copy data
-		void _copy_data(const SignalContainer& copy) {
-			uint64 N = _sizes.prod()*value_dimensions;
-			for (uint64 i = 0; i < N; i++) {
-				_data[i] = copy._data[i];
+		//! \return number of values of the buffer, including padding
+		uint64 _buffer_size() const {
+			if (Layout::planar) return _channel_stride*value_dimensions;
+			return (coord_dimensions == 1) ? unit_stride*_sizes(0) : _w(coord_dimensions-1)*_sizes(coord_dimensions-1);
+		}
+
+		//! Allocates a new buffer (zero initialized) owned by this container, starting at a multiple of buffer_alignment bytes
+		void _allocate() {
+			const uint64 extra = buffer_alignment / sizeof(value_data_type) + 1;
+			value_data_type* buffer = new value_data_type[_buffer_size() + extra]();
+			uint64 misalignment = reinterpret_cast<size_t>(buffer) % buffer_alignment;
+			_data = buffer + (misalignment ? (buffer_alignment - misalignment) / sizeof(value_data_type) : 0);
+			_keeper = boost::shared_ptr<value_data_type>(buffer, boost::checked_array_deleter<value_data_type>());
+			_maybe_shared = false;
+		}
+
+		//! Copies the data of the buffer shared with other containers into a buffer of its own. The reference count
+		//! is only read if the container has been copied, so unique containers pay a single test per access.
+		inline void _make_unique() {
+			if (BOOST_UNLIKELY(_maybe_shared)) _make_unique_shared();
+		}
+
+		//! _make_unique() for a container that has been copied
+		BOOST_NOINLINE void _make_unique_shared() {
+			if (_keeper.use_count() > 1) {
+				const value_data_type* shared = _data;
+				_allocate();
+				_copy_data(shared);
 			}
+			_maybe_shared = false;
+		}
+
+		//! Used to copy data
+		void _copy_data(const value_data_type* data) {
+			uint64 N = _buffer_size();
+			std::copy(data, data + N, _data);
+			signal_bytes_copied() += N*sizeof(value_data_type);
 		}
 
 	protected:
@@ -183,11 +494,21 @@ namespace imageplus {
 		//! upper hypercube point
 		coord_type _upper_point;
 
+		//! displacement of the lower point (0 when the hypercube starts at the origin)
+		int64 _origin;
+
+		//! distance between two channels of a unit
+		int64 _channel_stride;
+
 		//! pointer to the data
 		value_data_type *_data;
 
-		//! owner of the data?
-		bool _owner;
+		//! owner of the data (allocated by a container or adopted), shared by all the containers using it.
+		//! Empty if the container is a view of a buffer owned by someone else.
+		boost::shared_ptr<void> _keeper;
+
+		//! false if _keeper is known to be unique (set on the containers involved in a copy)
+		mutable bool _maybe_shared;
 	};
 
 }
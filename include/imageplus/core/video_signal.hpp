@@ -12,6 +12,7 @@
 #include <imageplus/core/signal.hpp>
 #include <imageplus/core/image_signal.hpp>
 #include <imageplus/core/colorspaces.hpp>
+#include <algorithm>
 
 namespace imageplus {
 
@@ -94,13 +95,13 @@ namespace imageplus {
 
 		//! Returns the x-size of a frame
 		//! \return columns of a frame
-		uint64 size_x() {
+		uint64 size_x() const {
 			return _sx;
 		}
 
 		//! Returns the y-size of a frame
 		//! \return rows of a frame
-		uint64 size_y() {
+		uint64 size_y() const {
 			return _sy;
 		}
 
@@ -127,6 +128,15 @@ namespace imageplus {
 			_color_space = color_space;
 		}
 
+		//! Uses a buffer owned by another object as the data of the video, without copying it (see Signal::adopt_data)
+		void adopt_data(const coord_type& sizes, value_data_type* data, const boost::shared_ptr<void>& keeper) {
+			BaseClassType::adopt_data(sizes, data, keeper);
+			_sx = sizes(0);
+			_sy = sizes(1);
+			_time_span = sizes(2);
+			_read_first_frame = true;
+		}
+
 		//! Read frame
 		void read_frame(std::string path, uint64 t) {
 			cv::Mat img = cv::imread(path, CV_LOAD_IMAGE_COLOR);
@@ -145,12 +155,18 @@ namespace imageplus {
 			coord_type offset(0,0,t);
 			value_data_type* data = BaseClassType::data(offset);
 
-			// export_to transfer the data from img to buffer
-			for(uint64 i = 0; i < _sy; i++)
-			{
-				uint8* m = img.ptr<uint8>(i);
-				for(uint64 j = 0; j < _sx*num_channels; j++)
-					(*data++) += static_cast<value_data_type>(m[j]);
+			if (img.isContinuous() && img.type() == CV_MAKETYPE(cv::DataType<value_data_type>::depth, channels)) {
+				// same layout, the frame is copied at once
+				const value_data_type* m = reinterpret_cast<const value_data_type*>(img.data);
+				std::copy(m, m + _sx*_sy*num_channels, data);
+			} else {
+				// export_to transfer the data from img to buffer
+				for(uint64 i = 0; i < _sy; i++)
+				{
+					uint8* m = img.ptr<uint8>(i);
+					for(uint64 j = 0; j < _sx*num_channels; j++)
+						(*data++) = static_cast<value_data_type>(m[j]);
+				}
 			}
 
 			_color_space = ColorSpaceRGB;
@@ -19,6 +19,7 @@
 #include <iostream>
 
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
 #include <string>
 
 #ifdef USE_XML
@@ -29,6 +30,82 @@ namespace imageplus
 {   
     // Forward declaration
     class CollaborativeDescriptors;
+
+    //! Assigns an integer slot to every descriptor identifier, so CollaborativeDescriptors can index its
+    //! descriptors in an array instead of searching them by their string identifier.
+    //!
+    //! \note Slots are assigned the first time an identifier is seen and are never released. The registry is
+    //! guarded by a mutex, so descriptors can be created in several threads, and find() looks identifiers up
+    //! without registering them.
+    class DescriptorRegistry
+    {
+    public:
+        //! Returns the slot of an identifier, registering it if it is new
+        //! \param[in] id : String identifier
+        //! \return slot of the identifier
+        static uint64 slot(const std::string& id)
+        {
+            boost::mutex::scoped_lock lock(_mutex());
+            std::map<std::string,uint64>& slots = _slots();
+            std::map<std::string,uint64>::iterator it = slots.find(id);
+            if( it!=slots.end() )
+                return it->second;
+
+            uint64 s = slots.size();
+            slots[id] = s;
+            return s;
+        }
+
+        //! Looks up the slot of an identifier without registering it
+        //! \param[in] id : String identifier
+        //! \param[out] s : slot of the identifier, if it is registered
+        //! \return false if the identifier has never been registered
+        static bool find(const std::string& id, uint64& s)
+        {
+            boost::mutex::scoped_lock lock(_mutex());
+            const std::map<std::string,uint64>& slots = _slots();
+            std::map<std::string,uint64>::const_iterator it = slots.find(id);
+            if( it==slots.end() )
+                return false;
+            s = it->second;
+            return true;
+        }
+
+        //! Returns the slot of a descriptor type whose identifier does not depend on its runtime parameters,
+        //! looking it up only the first time. The identifier must include the template parameters that change
+        //! the layout of the descriptor (e.g. "MeanValue<3>"), since descriptors of the same slot are cast to
+        //! each other.
+        //! \param[in] id : String identifier of the descriptors of type VDModel
+        //! \return slot of the identifier
+        template<class VDModel>
+        static uint64 slot_of(const std::string& id)
+        {
+            static const uint64 s = slot(id);
+            return s;
+        }
+
+        //! \return number of registered identifiers
+        static uint64 size()
+        {
+            boost::mutex::scoped_lock lock(_mutex());
+            return _slots().size();
+        }
+
+    protected:
+        //! Slots indexed by identifier
+        static std::map<std::string,uint64>& _slots()
+        {
+            static std::map<std::string,uint64> slots;
+            return slots;
+        }
+
+        //! Mutex guarding the slots
+        static boost::mutex& _mutex()
+        {
+            static boost::mutex mutex;
+            return mutex;
+        }
+    };
    
     //! Base class of all the Visual Descriptors, allowing us to store pointers to this class but 
     //!  running the derived class functions thanks to the virtual functions.
@@ -45,7 +122,17 @@ namespace imageplus
         //! \param[in] id : Strinf identifier
     	//! \param[in] recursive : Boolean that defines whether the descriptor is recursive or not
         DescriptorBase(const std::string& id, bool recursive=false) 
-                : _id(id), _recursive(recursive)
+                : _id(id), _recursive(recursive), _slot(DescriptorRegistry::slot(id))
+        {
+        };
+
+        //! Constructor receiving its id, whether the descriptor is recursive or not and its slot
+        //!
+        //! \param[in] id : String identifier
+        //! \param[in] recursive : Boolean that defines whether the descriptor is recursive or not
+        //! \param[in] slot : Slot of id in the DescriptorRegistry (see DescriptorRegistry::slot_of)
+        DescriptorBase(const std::string& id, bool recursive, uint64 slot)
+                : _id(id), _recursive(recursive), _slot(slot)
         {
         };
         
@@ -58,16 +145,31 @@ namespace imageplus
         {
             return _id;
         }
+
+        //! Returns the slot of the descriptor in CollaborativeDescriptors
+        //! \return The slot assigned to the identifier by DescriptorRegistry
+        uint64 slot() const
+        {
+            return _slot;
+        }
        
         //! \brief Calculates the descriptor of the parent region given its siblings.
         //!
         //! \param[in] son1_descs : CollaborativeDescriptors of the son 1
         //! \param[in] son2_descs : CollaborativeDescriptors of the son 2
         //! \param[in] peer_descs : Pointer to CollaborativeDescriptors, in principle is never 0x0 but it is a good idea to ASSERT it
-        void recursive_calculate(CollaborativeDescriptors& son1_descs, CollaborativeDescriptors& son2_descs, CollaborativeDescriptors* peer_descs)
+        virtual void recursive_calculate(CollaborativeDescriptors& /*son1_descs*/, CollaborativeDescriptors& /*son2_descs*/, CollaborativeDescriptors* /*peer_descs*/)
         {
             throw ImagePlusError("Descriptor '" + id() + "' is not implemented recursively.");
         }
+
+        //! Returns a new (not calculated) descriptor of the same type and parameters, used as prototype
+        //! to compute the descriptor of the regions created by a merging.
+        //! \return new descriptor, owned by the caller
+        virtual DescriptorBase* clone() const
+        {
+            throw ImagePlusError("Descriptor '" + id() + "' can not be cloned.");
+        }
         
     #ifdef USE_XML
         //! \returns the name of the descriptor to be written to the XML descriptors file
@@ -104,6 +206,9 @@ namespace imageplus
         
         //! String identifier
         bool _recursive;
+
+        //! Slot of the identifier
+        uint64 _slot;
     };
     
     
@@ -115,6 +220,9 @@ namespace imageplus
     //! 
     //! \note To compute descriptors, please refer to the helper functions available below
     //!
+    //! Descriptors are stored in an array indexed by their slot (DescriptorBase::slot), so the functions receiving
+    //! a descriptor do not search its identifier. The functions receiving a string identifier look up its slot first.
+    //!
     //! \author Jordi Pont <jordi.pont@upc.edu>
     //!
     //! \date 10-9-2009
@@ -151,16 +259,16 @@ namespace imageplus
             else if (_global_desc==0x0)
                 _global_desc = this;
             
-            std::string id = desc->id();
-            std::map<std::string,VDBasePtr>::iterator it = _vdescs.find(id);
-            if( it!=_vdescs.end() )
+            const uint64 slot = desc->slot();
+            VDBasePtr stored = _find(slot);
+            if( stored!=0x0 )
             {
                 delete desc;
-                desc = (VDModel*)((it->second));
+                desc = (VDModel*)stored;
             }
             else
             {
-                _vdescs[id]=desc;
+                _store(slot, desc);
                 desc->calculate(first, last, this);
             }
             return *desc;
@@ -173,29 +281,33 @@ namespace imageplus
         //! \param[in] son1_desc : CollaborativeDescriptors of one son
         //! \param[in] son2_desc : CollaborativeDescriptors of the other son
         //! \param[in] global_desc : Pointer to the global CollaborativeDescriptors (for instance, of the whole image)
+        //! \param[in] keep_sons : Whether the descriptors of the sons are kept or deleted once combined
         //!
         //! \returns the calculated descriptor of a region given their sons CollaborativeDescriptors
         //!
         template<class VDModel>
-        VDModel& recursive_calculate(VDModel* desc, CollaborativeDescriptors& son1_desc, CollaborativeDescriptors& son2_desc, CollaborativeDescriptors* global_desc=0x0)
+        VDModel& recursive_calculate(VDModel* desc, CollaborativeDescriptors& son1_desc, CollaborativeDescriptors& son2_desc, CollaborativeDescriptors* global_desc=0x0, bool keep_sons=false)
         {
             if((global_desc!=0x0) && (_global_desc==0x0))
                 _global_desc = global_desc;
             
-            std::string id = desc->id();
-            std::map<std::string,VDBasePtr>::iterator it = _vdescs.find(id);
-            if( it!=_vdescs.end() )
+            const uint64 slot = desc->slot();
+            VDBasePtr stored = _find(slot);
+            if( stored!=0x0 )
             {
                 delete desc;
-                desc = (VDModel*)((it->second));
+                desc = (VDModel*)stored;
             }
             else
             {
-                _vdescs[id]=VDBasePtr(desc);
+                _store(slot, desc);
                 desc->recursive_calculate(son1_desc, son2_desc, this);
 
-                son1_desc.delete_descriptor(id);
-                son2_desc.delete_descriptor(id);
+                if (!keep_sons)
+                {
+                    son1_desc.delete_descriptor(slot);
+                    son2_desc.delete_descriptor(slot);
+                }
             }
             return *desc;
         }
@@ -215,9 +327,7 @@ namespace imageplus
         VDModel& create(VDModel* desc)
         {                     
             // ASSERT not calculated
-            std::string id = desc->id();
-
-            _vdescs[id] = desc;
+            _store(desc->slot(), desc);
             return *desc;
         }
         
@@ -230,12 +340,9 @@ namespace imageplus
         template<class VDModel>
         VDModel& get(const VDModel& desc)
         {           
-            std::string id = desc.id();
-            
-            //ASSERT(is_calculated(id), "You called 'get' of a descriptor "+ id +" that was not previously calculated.");
+            //ASSERT(is_calculated(desc.slot()), "You called 'get' of a descriptor "+ desc.id() +" that was not previously calculated.");
             
-            std::map<std::string,VDBasePtr>::iterator it = _vdescs.find(id);
-            return *((VDModel*)(it->second));
+            return *((VDModel*)(_vdescs[desc.slot()]));
         }
         
         //! Gets the descriptor of the type defined by desc
@@ -247,12 +354,9 @@ namespace imageplus
         template<class VDModel>
         const VDModel& get(const VDModel& desc) const
         {           
-            std::string id = desc.id();
+            //ASSERT(is_calculated(desc.slot()), "You called 'get' of a descriptor "+ desc.id() +" that was not previously calculated.");
             
-            //ASSERT(is_calculated(id), "You called 'get' of a descriptor "+ id +" that was not previously calculated.");
-            
-            std::map<std::string,VDBasePtr>::const_iterator it = _vdescs.find(id);
-            return *((VDModel*)(it->second));
+            return *((VDModel*)(_vdescs[desc.slot()]));
         }
 
         //! Gets the pointer to the descriptor of the type defined by id. Note that the pointer 
@@ -267,8 +371,7 @@ namespace imageplus
         {
             //ASSERT(is_calculated(id), "You called 'get' of a descriptor "+ id +" that was not previously calculated.");
             
-            std::map<std::string,VDBasePtr>::const_iterator it = _vdescs.find(id);
-            return (it->second);
+            return _find(id);
         }
         
         //! Gets the pointer to the descriptor of the type defined by id. Note that the pointer 
@@ -284,8 +387,7 @@ namespace imageplus
         {
             //ASSERT(is_calculated(id), "You called 'get' of a descriptor "+ id +" that was not previously calculated.");
             
-            std::map<std::string,VDBasePtr>::const_iterator it = _vdescs.find(id);
-            return *((VDModel*)(it->second));
+            return *((VDModel*)(_find(id)));
         }
 
         //! Checks whether a descriptor is already calculated
@@ -294,11 +396,16 @@ namespace imageplus
         //! \return Whether the descriptor is calculated or not      
         bool is_calculated(const std::string& id) const
         {
-            std::map<std::string,VDBasePtr>::const_iterator it = _vdescs.find(id);
-            if( it!=_vdescs.end() ) 
-                return true;
-            else
-                return false;        
+            return _find(id)!=0x0;
+        }
+
+        //! Checks whether a descriptor is already calculated
+        //! 
+        //! \param[in] slot: Slot of the descriptor (DescriptorBase::slot)
+        //! \return Whether the descriptor is calculated or not
+        bool is_calculated(uint64 slot) const
+        {
+            return _find(slot)!=0x0;
         }
     
         
@@ -319,26 +426,56 @@ namespace imageplus
         }
         
         void delete_descriptor(std::string id) {
+        	uint64 slot;
+        	if (DescriptorRegistry::find(id, slot)) delete_descriptor(slot);
+        }
+
+        //! Deletes a calculated descriptor
+        //! \param[in] slot: Slot of the descriptor (DescriptorBase::slot)
+        void delete_descriptor(uint64 slot) {
         	/*Erase the recursive descriptors*/
-        	delete _vdescs[id];
-        	_vdescs.erase(_vdescs.find(id));
+        	if (slot < _vdescs.size()) {
+        		delete _vdescs[slot];
+        		_vdescs[slot] = 0x0;
+        	}
         }
 
         //! Deletes all calculated descriptors
         void clear()
         {
-        	for (std::map<std::string,VDBasePtr>::iterator it = _vdescs.begin(); it != _vdescs.end(); ++it)
-        		delete it->second;
+        	for (std::vector<VDBasePtr>::iterator it = _vdescs.begin(); it != _vdescs.end(); ++it)
+        		delete *it;
 
             _vdescs.clear();
         }
 
     private:
+        //! Returns the descriptor stored in a slot, or 0x0
+        VDBasePtr _find(uint64 slot) const
+        {
+            return (slot < _vdescs.size()) ? _vdescs[slot] : 0x0;
+        }
+
+        //! Returns the descriptor with an identifier, or 0x0 (also if the identifier is not registered)
+        VDBasePtr _find(const std::string& id) const
+        {
+            uint64 slot;
+            return DescriptorRegistry::find(id, slot) ? _find(slot) : 0x0;
+        }
+
+        //! Stores a descriptor in its slot
+        void _store(uint64 slot, VDBasePtr desc)
+        {
+            if (slot >= _vdescs.size())
+                _vdescs.resize(slot+1, 0x0);
+            _vdescs[slot] = desc;
+        }
+
         //! Ponter to global collaborative descriptors
         CollaborativeDescriptors* _global_desc;
 
-        //! Set of pointers to visual descriptor, indexed by its identifiers
-        std::map<std::string,VDBasePtr> _vdescs;
+        //! Set of pointers to visual descriptor, indexed by the slots of their identifiers (0x0 if not calculated)
+        std::vector<VDBasePtr> _vdescs;
     };
     
     
@@ -449,7 +586,7 @@ namespace imageplus
         {
             return region.coll_vd().calculate(desc, input.colors_begin(region), input.colors_end(region), &input.coll_vd());
         }
-        else if(region.coll_vd().is_calculated(desc->id()))
+        else if(region.coll_vd().is_calculated(desc->slot()))
         {
         	VDModel& descriptor = region.coll_vd().get(*desc);
         	delete desc;
@@ -470,7 +607,7 @@ namespace imageplus
                 RegPointer curr = to_look.back();
                 to_look.pop_back();
                  
-                if(curr->coll_vd().is_calculated(desc->id()))
+                if(curr->coll_vd().is_calculated(desc->slot()))
                 {
                     n_to_look--;
                 }
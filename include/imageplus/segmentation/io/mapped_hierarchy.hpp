@@ -0,0 +1,487 @@
+/*
+ * mapped_hierarchy.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef MAPPED_HIERARCHY_HPP_
+#define MAPPED_HIERARCHY_HPP_
+
+#include <imageplus/core/imageplus_types.hpp>
+#include <imageplus/core/exceptions.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/static_assert.hpp>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Header of a mapped hierarchy file (see write_mapped_hierarchy). All the fields and arrays are stored in the
+		//! byte order of the machine that wrote the file, every array starts at a multiple of 64 bytes from the
+		//! beginning of the file, and a section with offset 0 is not stored.
+		struct MappedHierarchyHeader {
+
+			static const uint32 current_version = 1;
+			static const uint32 byte_order_mark = 0x01020304;
+			static const uint64 max_dimensions = 4;
+			static const uint64 section_alignment = 64;
+
+			//! Flags
+			static const uint64 has_features = 1;
+
+			//! Sections of the file
+			enum Section {
+				leaves_plane = 0,	//!< label of every unit in the leaves partition (label_size bytes per unit, in memory order)
+				parents,			//!< parent of every region (uint64, no_region for roots and labels without region)
+				child_offsets,		//!< children of region l are children[child_offsets[l], child_offsets[l+1]) (uint64, num_regions+1)
+				children,			//!< labels of the children of all the regions (uint64)
+				leaf_ranges,		//!< leaves of region l are leaf_order[leaf_ranges[2l], leaf_ranges[2l+1]) (uint64, 2 per region)
+				leaf_order,			//!< labels of the leaves in depth-first order (uint64)
+				areas,				//!< number of units of every region (uint64, optional)
+				bounding_boxes,		//!< lowest and highest coordinate of every region in every dimension (int64, 2*dimensions per region, optional)
+				num_sections
+			};
+
+			//! "IPHRCHY" followed by a zero
+			char magic[8];
+
+			//! format version
+			uint32 version;
+
+			//! byte_order_mark written in the byte order of the file
+			uint32 byte_order;
+
+			//! size of this header in bytes
+			uint64 header_size;
+
+			//! total size of the file in bytes
+			uint64 file_size;
+
+			//! combination of flags
+			uint64 flags;
+
+			//! number of dimensions of the leaves partition
+			uint64 dimensions;
+
+			//! size of the leaves partition in every dimension (0 beyond dimensions)
+			uint64 sizes[max_dimensions];
+
+			//! bytes of every label of the leaves plane
+			uint64 label_size;
+
+			//! number of units of the leaves partition
+			uint64 num_units;
+
+			//! max label + 1
+			uint64 num_regions;
+
+			//! number of leaves
+			uint64 num_leaves;
+
+			//! number of entries of the children section
+			uint64 num_children;
+
+			//! offset in bytes of every section from the beginning of the file
+			uint64 offsets[num_sections];
+
+			//! \return true if the magic, version and byte order are the ones of this implementation
+			bool is_valid() const {
+				return std::memcmp(magic, "IPHRCHY", 8) == 0 && version == current_version && byte_order == byte_order_mark && header_size == sizeof(MappedHierarchyHeader);
+			}
+		};
+
+		//! Label of the parent of roots
+		static const uint64 no_region = std::numeric_limits<uint64>::max();
+
+		//! Writes a hierarchy in the mapped hierarchy format, which can be opened without rebuilding it with MappedHierarchy.
+		//! The file contains the leaves partition, the parent and children of every region and the leaves of every
+		//! region in depth-first order, and optionally the area and bounding box of every region.
+		//! \param[in] hierarchy : hierarchy to write (e.g. HierarchicalRegionPartition)
+		//! \param[in] path : path of the file
+		//! \param[in] features : if true the area and bounding box of every region are stored too
+		template<class HierarchyModel>
+		void write_mapped_hierarchy(HierarchyModel& hierarchy, const std::string& path, bool features = true) {
+			typedef typename HierarchyModel::PartitionType		PartitionType;
+			typedef typename HierarchyModel::RegionType			RegionType;
+			typedef typename PartitionType::value_data_type		label_type;
+			typedef typename HierarchyModel::global_iterator	global_iterator;
+
+			static const uint64 dimensions = PartitionType::coord_dimensions;
+			BOOST_STATIC_ASSERT(dimensions <= MappedHierarchyHeader::max_dimensions);
+			// the leaves plane is written as a dense array
+			BOOST_STATIC_ASSERT(PartitionType::packed);
+
+			PartitionType& leaves = hierarchy.leaves_partition();
+			const typename PartitionType::coord_type sizes = leaves.sizes();
+			const uint64 num_units = sizes.prod();
+			const uint64 num_regions = hierarchy.max_label() + 1;
+
+			// parents and children (CSR)
+			std::vector<uint64> parents(num_regions, no_region);
+			std::vector<uint64> child_offsets(num_regions + 1, 0);
+			std::vector<bool> present(num_regions, false);
+			global_iterator it = hierarchy.begin();
+			global_iterator it_end = hierarchy.end();
+			for (; it != it_end; ++it) {
+				RegionType& r = *it;
+				present[r.label()] = true;
+				if (r.parent() != NULL) parents[r.label()] = r.parent()->label();
+				child_offsets[r.label() + 1] = r.children().size();
+			}
+			for (uint64 l = 0; l < num_regions; l++) child_offsets[l+1] += child_offsets[l];
+
+			std::vector<uint64> children(child_offsets[num_regions]);
+			for (it = hierarchy.begin(); it != it_end; ++it) {
+				RegionType& r = *it;
+				for (uint64 i = 0; i < r.children().size(); i++) children[child_offsets[r.label()] + i] = r.child(i)->label();
+			}
+
+			// leaves in depth-first order from every root, and their ranges
+			std::vector<uint64> leaf_ranges(2*num_regions, 0);
+			std::vector<uint64> leaf_order;
+			std::vector<uint64> post_order;
+			std::vector<std::pair<uint64, bool> > stack;
+			for (uint64 root = 0; root < num_regions; root++) {
+				if (!present[root] || parents[root] != no_region) continue;
+				stack.push_back(std::make_pair(root, false));
+				while (!stack.empty()) {
+					const uint64 l = stack.back().first;
+					if (!stack.back().second) {
+						stack.back().second = true;
+						leaf_ranges[2*l] = leaf_order.size();
+						if (child_offsets[l] == child_offsets[l+1]) leaf_order.push_back(l);
+						for (uint64 i = child_offsets[l+1]; i > child_offsets[l]; i--) stack.push_back(std::make_pair(children[i-1], false));
+					} else {
+						leaf_ranges[2*l+1] = leaf_order.size();
+						post_order.push_back(l);
+						stack.pop_back();
+					}
+				}
+			}
+
+			// area and bounding box of the leaves, scanning the leaves plane, and of the rest combining their children
+			std::vector<uint64> areas;
+			std::vector<int64> boxes;
+			// read only, so a shared buffer is not copied
+			const label_type* labels = static_cast<const PartitionType&>(leaves).data();
+			if (features) {
+				areas.assign(num_regions, 0);
+				boxes.resize(2*dimensions*num_regions);
+				for (uint64 l = 0; l < num_regions; l++) {
+					for (uint64 k = 0; k < dimensions; k++) {
+						boxes[2*dimensions*l + k] = std::numeric_limits<int64>::max();
+						boxes[2*dimensions*l + dimensions + k] = std::numeric_limits<int64>::min();
+					}
+				}
+
+				int64 pos[dimensions];
+				for (uint64 k = 0; k < dimensions; k++) pos[k] = 0;
+				for (uint64 u = 0; u < num_units; u++) {
+					int64* box = &boxes[2*dimensions*labels[u]];
+					areas[labels[u]]++;
+					for (uint64 k = 0; k < dimensions; k++) {
+						if (pos[k] < box[k]) box[k] = pos[k];
+						if (pos[k] > box[dimensions + k]) box[dimensions + k] = pos[k];
+					}
+					for (uint64 k = 0; k < dimensions; k++) {
+						if (++pos[k] < sizes(k)) break;
+						pos[k] = 0;
+					}
+				}
+
+				for (uint64 i = 0; i < post_order.size(); i++) {
+					const uint64 l = post_order[i];
+					int64* box = &boxes[2*dimensions*l];
+					for (uint64 c = child_offsets[l]; c < child_offsets[l+1]; c++) {
+						const int64* child_box = &boxes[2*dimensions*children[c]];
+						areas[l] += areas[children[c]];
+						for (uint64 k = 0; k < dimensions; k++) {
+							if (child_box[k] < box[k]) box[k] = child_box[k];
+							if (child_box[dimensions + k] > box[dimensions + k]) box[dimensions + k] = child_box[dimensions + k];
+						}
+					}
+				}
+			}
+
+			// header
+			MappedHierarchyHeader header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, "IPHRCHY", 8);
+			header.version = MappedHierarchyHeader::current_version;
+			header.byte_order = MappedHierarchyHeader::byte_order_mark;
+			header.header_size = sizeof(MappedHierarchyHeader);
+			header.flags = features ? MappedHierarchyHeader::has_features : 0;
+			header.dimensions = dimensions;
+			for (uint64 k = 0; k < dimensions; k++) header.sizes[k] = sizes(k);
+			header.label_size = sizeof(label_type);
+			header.num_units = num_units;
+			header.num_regions = num_regions;
+			header.num_leaves = leaf_order.size();
+			header.num_children = children.size();
+
+			const void* data[MappedHierarchyHeader::num_sections] = {labels, &parents[0], &child_offsets[0], children.empty() ? NULL : &children[0],
+					&leaf_ranges[0], leaf_order.empty() ? NULL : &leaf_order[0], areas.empty() ? NULL : &areas[0], boxes.empty() ? NULL : &boxes[0]};
+			const uint64 bytes[MappedHierarchyHeader::num_sections] = {num_units*sizeof(label_type), parents.size()*sizeof(uint64), child_offsets.size()*sizeof(uint64),
+					children.size()*sizeof(uint64), leaf_ranges.size()*sizeof(uint64), leaf_order.size()*sizeof(uint64), areas.size()*sizeof(uint64), boxes.size()*sizeof(int64)};
+
+			const uint64 alignment = MappedHierarchyHeader::section_alignment;
+			uint64 offset = sizeof(MappedHierarchyHeader);
+			for (uint64 s = 0; s < MappedHierarchyHeader::num_sections; s++) {
+				if (!features && (s == MappedHierarchyHeader::areas || s == MappedHierarchyHeader::bounding_boxes)) continue;
+				offset = (offset + alignment - 1) / alignment * alignment;
+				header.offsets[s] = offset;
+				offset += bytes[s];
+			}
+			header.file_size = offset;
+
+			std::ofstream out(path.c_str(), std::fstream::binary);
+			if (!out.is_open()) throw ImagePlusError("write_mapped_hierarchy: cannot open " + path);
+
+			out.write((const char*)&header, sizeof(header));
+			uint64 written = sizeof(header);
+			const char padding[MappedHierarchyHeader::section_alignment] = {0};
+			for (uint64 s = 0; s < MappedHierarchyHeader::num_sections; s++) {
+				if (header.offsets[s] == 0) continue;
+				out.write(padding, header.offsets[s] - written);
+				if (bytes[s] > 0) out.write((const char*)data[s], bytes[s]);
+				written = header.offsets[s] + bytes[s];
+			}
+			if (!out) throw ImagePlusError("write_mapped_hierarchy: error writing " + path);
+		}
+
+		//! Read-only view of a hierarchy written with write_mapped_hierarchy. The file is mapped in memory and the
+		//! queries read it directly: opening a file only validates its header and that every section fits in the
+		//! file, whatever its size, and the pages are loaded by the system when they are first accessed. The
+		//! contents of the sections (e.g. the labels of the children) are not checked.
+		//!
+		//! Regions are identified by their label. Copies of the view share the mapping, which is released with
+		//! the last one.
+		//!
+		//! \tparam PartitionModel : type of the leaves partition written (gives the label type and the dimensions)
+		template<class PartitionModel>
+		class MappedHierarchy {
+		public:
+
+			typedef typename PartitionModel::value_data_type	label_type;
+			typedef typename PartitionModel::coord_type			coord_type;
+
+			static const uint64 dimensions = PartitionModel::coord_dimensions;
+
+			//! Default constructor, the view is empty until open() is called
+			MappedHierarchy() : _header(NULL), _base(NULL) {
+			}
+
+			//! Constructor opening a file
+			//! \param[in] path : file written with write_mapped_hierarchy
+			MappedHierarchy(const std::string& path) : _header(NULL), _base(NULL) {
+				open(path);
+			}
+
+			//! Maps a file, checking that it has been written on a machine with the same byte order and with the
+			//! label type and dimensions of PartitionModel
+			//! \param[in] path : file written with write_mapped_hierarchy
+			void open(const std::string& path) {
+				boost::shared_ptr<boost::interprocess::mapped_region> region;
+				try {
+					boost::interprocess::file_mapping file(path.c_str(), boost::interprocess::read_only);
+					region.reset(new boost::interprocess::mapped_region(file, boost::interprocess::read_only));
+				} catch (boost::interprocess::interprocess_exception& e) {
+					throw ImagePlusError("MappedHierarchy: cannot map " + path + ": " + e.what());
+				}
+
+				const char* base = (const char*)region->get_address();
+				const MappedHierarchyHeader* header = (const MappedHierarchyHeader*)base;
+				if (region->get_size() < sizeof(MappedHierarchyHeader) || !header->is_valid()) {
+					throw ImagePlusError("MappedHierarchy: " + path + " is not a mapped hierarchy of this version and byte order");
+				}
+				if (header->file_size > region->get_size()) {
+					throw ImagePlusError("MappedHierarchy: " + path + " is truncated");
+				}
+				if (header->dimensions != dimensions || header->label_size != sizeof(label_type)) {
+					throw ImagePlusError("MappedHierarchy: the dimensions or the label type of " + path + " do not match the partition type");
+				}
+
+				// every section must lie inside the file, so the queries never read outside the mapping
+				uint64 units = 1;
+				for (uint64 k = 0; k < dimensions; k++) {
+					if (header->sizes[k] != 0 && units > std::numeric_limits<uint64>::max() / header->sizes[k]) units = 0;
+					units *= header->sizes[k];
+				}
+				const bool features = (header->flags & MappedHierarchyHeader::has_features) != 0;
+				if (units != header->num_units || header->num_regions == std::numeric_limits<uint64>::max()
+						|| !_section_fits(*header, MappedHierarchyHeader::leaves_plane, header->num_units, sizeof(label_type))
+						|| !_section_fits(*header, MappedHierarchyHeader::parents, header->num_regions, sizeof(uint64))
+						|| !_section_fits(*header, MappedHierarchyHeader::child_offsets, header->num_regions + 1, sizeof(uint64))
+						|| !_section_fits(*header, MappedHierarchyHeader::children, header->num_children, sizeof(uint64))
+						|| !_section_fits(*header, MappedHierarchyHeader::leaf_ranges, header->num_regions, 2*sizeof(uint64))
+						|| !_section_fits(*header, MappedHierarchyHeader::leaf_order, header->num_leaves, sizeof(uint64))
+						|| (features && !_section_fits(*header, MappedHierarchyHeader::areas, header->num_regions, sizeof(uint64)))
+						|| (features && !_section_fits(*header, MappedHierarchyHeader::bounding_boxes, header->num_regions, 2*dimensions*sizeof(int64)))) {
+					throw ImagePlusError("MappedHierarchy: the sections of " + path + " do not fit in the file");
+				}
+
+				_region = region;
+				_header = header;
+				_base = base;
+			}
+
+			//! \return true if a file is mapped
+			bool is_open() const {
+				return _header != NULL;
+			}
+
+			//! \return header of the file
+			const MappedHierarchyHeader& header() const {
+				return *_header;
+			}
+
+			//! \return max label + 1 (labels without region have no parent, children nor leaves)
+			uint64 num_regions() const {
+				return _header->num_regions;
+			}
+
+			//! \return number of leaves
+			uint64 num_leaves() const {
+				return _header->num_leaves;
+			}
+
+			//! \return size of the leaves partition
+			coord_type sizes() const {
+				coord_type s;
+				for (uint64 k = 0; k < dimensions; k++) s(k) = _header->sizes[k];
+				return s;
+			}
+
+			//! \return labels of the leaves partition, as a dense array in memory order
+			const label_type* leaves_data() const {
+				return _section<label_type>(MappedHierarchyHeader::leaves_plane);
+			}
+
+			//! \return label of the leaf containing a unit
+			label_type leaf(const coord_type& coord) const {
+				uint64 u = 0;
+				for (uint64 k = dimensions; k > 0; k--) u = u*_header->sizes[k-1] + coord(k-1);
+				return leaves_data()[u];
+			}
+
+			//! \return label of the parent of a region, or no_region for roots
+			uint64 parent(uint64 label) const {
+				return _section<uint64>(MappedHierarchyHeader::parents)[label];
+			}
+
+			//! \return true if the region has no parent
+			bool is_root(uint64 label) const {
+				return parent(label) == no_region && contains(label);
+			}
+
+			//! \return true if a region with this label exists
+			bool contains(uint64 label) const {
+				const uint64* ranges = _section<uint64>(MappedHierarchyHeader::leaf_ranges);
+				return label < num_regions() && ranges[2*label] != ranges[2*label+1];
+			}
+
+			//! \return number of children of a region
+			uint64 num_children(uint64 label) const {
+				const uint64* offsets = _section<uint64>(MappedHierarchyHeader::child_offsets);
+				return offsets[label+1] - offsets[label];
+			}
+
+			//! \return true if the region has no children
+			bool is_leaf(uint64 label) const {
+				return num_children(label) == 0;
+			}
+
+			//! \return label of the i-th child of a region
+			uint64 child(uint64 label, uint64 i) const {
+				return children_begin(label)[i];
+			}
+
+			//! \return first of the labels of the children of a region
+			const uint64* children_begin(uint64 label) const {
+				return _section<uint64>(MappedHierarchyHeader::children) + _section<uint64>(MappedHierarchyHeader::child_offsets)[label];
+			}
+
+			//! \return end of the labels of the children of a region
+			const uint64* children_end(uint64 label) const {
+				return _section<uint64>(MappedHierarchyHeader::children) + _section<uint64>(MappedHierarchyHeader::child_offsets)[label+1];
+			}
+
+			//! \return first of the labels of the leaves of a region (the leaves of every region are contiguous)
+			const uint64* leaves_begin(uint64 label) const {
+				return _section<uint64>(MappedHierarchyHeader::leaf_order) + _section<uint64>(MappedHierarchyHeader::leaf_ranges)[2*label];
+			}
+
+			//! \return end of the labels of the leaves of a region
+			const uint64* leaves_end(uint64 label) const {
+				return _section<uint64>(MappedHierarchyHeader::leaf_order) + _section<uint64>(MappedHierarchyHeader::leaf_ranges)[2*label+1];
+			}
+
+			//! \return number of leaves of a region
+			uint64 num_leaves(uint64 label) const {
+				return leaves_end(label) - leaves_begin(label);
+			}
+
+			//! \return true if region descendant is region ancestor or one of its descendants (in constant time)
+			bool is_descendant(uint64 descendant, uint64 ancestor) const {
+				const uint64* ranges = _section<uint64>(MappedHierarchyHeader::leaf_ranges);
+				return ranges[2*ancestor] <= ranges[2*descendant] && ranges[2*descendant+1] <= ranges[2*ancestor+1] && contains(descendant);
+			}
+
+			//! \return true if the file stores the area and bounding box of the regions
+			bool has_features() const {
+				return (_header->flags & MappedHierarchyHeader::has_features) != 0;
+			}
+
+			//! \return number of units of a region (requires has_features())
+			uint64 area(uint64 label) const {
+				return _section<uint64>(MappedHierarchyHeader::areas)[label];
+			}
+
+			//! \return lowest coordinate of a region in dimension k (requires has_features())
+			int64 min(uint64 label, uint64 k) const {
+				return _section<int64>(MappedHierarchyHeader::bounding_boxes)[2*dimensions*label + k];
+			}
+
+			//! \return highest coordinate of a region in dimension k, inclusive (requires has_features())
+			int64 max(uint64 label, uint64 k) const {
+				return _section<int64>(MappedHierarchyHeader::bounding_boxes)[2*dimensions*label + dimensions + k];
+			}
+
+		protected:
+
+			//! \return true if a section of count elements of elem_size bytes is aligned and lies between the header
+			//! and the end of the file
+			static bool _section_fits(const MappedHierarchyHeader& header, uint64 section, uint64 count, uint64 elem_size) {
+				const uint64 offset = header.offsets[section];
+				if (offset < header.header_size || offset > header.file_size || offset % MappedHierarchyHeader::section_alignment != 0) return false;
+				return count <= (header.file_size - offset) / elem_size;
+			}
+
+			//! \return first element of a section
+			template<typename T>
+			inline const T* _section(uint64 section) const {
+				return (const T*)(_base + _header->offsets[section]);
+			}
+
+			//! mapping of the file, shared by the copies of the view
+			boost::shared_ptr<boost::interprocess::mapped_region> _region;
+
+			//! header at the beginning of the mapping
+			const MappedHierarchyHeader* _header;
+
+			//! beginning of the mapping
+			const char* _base;
+		};
+
+	}
+}
+
+#endif /* MAPPED_HIERARCHY_HPP_ */
@@ -0,0 +1,128 @@
+/*
+ * merging_sequence_read.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef MERGING_SEQUENCE_READ_HPP_
+#define MERGING_SEQUENCE_READ_HPP_
+
+#include <imageplus/core/imageplus_types.hpp>
+#include <imageplus/core/exceptions.hpp>
+#include <istream>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Parser of merging sequences in text (groups of three unsigned integers: son1, son2 and father,
+		//! separated by whitespace), as stored after the partition and image paths of PRL metadata files.
+		//!
+		//! The stream is read in blocks of block_size bytes and the numbers are parsed by hand from the block,
+		//! so the text is never held in memory as a whole. The mergings can be stored in a flat array of
+		//! triples or passed one by one to a callback.
+		class MergingSequenceReader {
+		public:
+
+			//! Bytes read from the stream at once
+			static const uint64 block_size = 1 << 16;
+
+			//! Constructor
+			//! \param[in] in : stream positioned at the first merging
+			MergingSequenceReader(std::istream& in) : _in(in), _block(block_size), _pos(0), _end(0) {
+			}
+
+			//! Parses the next number
+			//! \param[out] value : number read
+			//! \return false if the stream has no more numbers
+			bool next(uint64& value) {
+				// skip whitespace
+				while (true) {
+					if (_pos == _end && !_refill()) return false;
+					const char c = _block[_pos];
+					if (c != ' ' && c != '\n' && c != '\t' && c != '\r') break;
+					_pos++;
+				}
+
+				if (_block[_pos] < '0' || _block[_pos] > '9') throw ImagePlusError("MergingSequenceReader: unexpected character in merging sequence");
+
+				// digits, possibly across blocks
+				value = 0;
+				while (true) {
+					while (_pos < _end) {
+						const uint8 digit = (uint8)(_block[_pos] - '0');
+						if (digit > 9) return true;
+						value = value*10 + digit;
+						_pos++;
+					}
+					if (!_refill()) return true;
+				}
+			}
+
+			//! Parses all the mergings, calling callback(son1, son2, father) for every one in order
+			//! \param[in] callback : functor receiving the mergings
+			//! \return number of mergings
+			template<class MergingCallback>
+			uint64 for_each(MergingCallback& callback) {
+				uint64 count = 0;
+				uint64 son1, son2, father;
+				while (next(son1)) {
+					if (!next(son2) || !next(father)) throw ImagePlusError("MergingSequenceReader: incomplete merging at the end of the sequence");
+					callback(son1, son2, father);
+					count++;
+				}
+				return count;
+			}
+
+			//! Parses all the mergings into a flat array
+			//! \param[out] triples : son1, son2 and father of every merging, appended in order
+			//! \return number of mergings
+			uint64 read(std::vector<uint64>& triples) {
+				_appender appender(triples);
+				return for_each(appender);
+			}
+
+		protected:
+
+			//! Callback appending the mergings to a flat array
+			struct _appender {
+
+				std::vector<uint64>& triples;
+
+				_appender(std::vector<uint64>& t) : triples(t) {
+				}
+
+				inline void operator()(uint64 son1, uint64 son2, uint64 father) {
+					triples.push_back(son1);
+					triples.push_back(son2);
+					triples.push_back(father);
+				}
+			};
+
+			//! Reads the next block
+			//! \return false at the end of the stream
+			bool _refill() {
+				_in.read(&_block[0], block_size);
+				_pos = 0;
+				_end = _in.gcount();
+				return _end > 0;
+			}
+
+			//! stream being parsed
+			std::istream& _in;
+
+			//! last block read
+			std::vector<char> _block;
+
+			//! next character of _block to parse
+			uint64 _pos;
+
+			//! number of characters of _block
+			uint64 _end;
+		};
+
+	}
+}
+
+#endif /* MERGING_SEQUENCE_READ_HPP_ */
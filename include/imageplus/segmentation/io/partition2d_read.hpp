@@ -9,12 +9,32 @@
 #define PARTITION2D_READ_HPP_
 
 #include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/shared_ptr.hpp>
 #include <imageplus/segmentation/partition/partition.hpp>
 #include <imageplus/segmentation/io/readbitstream.hpp>
+#include <imageplus/segmentation/io/merging_sequence_read.hpp>
+#include <algorithm>
+#include <cstring>
 
 namespace imageplus {
 	namespace segmentation {
 
+	//!
+	//! \brief Table of the "run-lengths" of PRL files indexed by their next 9 bits: length << 4 | bits of the code
+	//!
+	inline const uint16* prl_length_codes() {
+		struct table {
+			uint16 codes[512];
+			table() {
+				for (uint64 v = 0; v < 512; v++) codes[v] = (v < 256) ? (uint16)((((v >> 6) + 1) << 4) | 3) : (uint16)(((v - 256) << 4) | 9);
+			}
+		};
+		static const table t;
+		return t.codes;
+	}
+
 	template<class PartitionModel>
 	class PRLReader {
 
@@ -31,7 +51,7 @@ namespace imageplus {
 			std::ifstream in_file;
 			in_file.open( _filename.c_str(), std::ios::in);
 			if(!in_file.is_open()) {
-				throw;
+				throw ImagePlusFileNotFound(_filename);
 			}
 
 			std::string partition_file;
@@ -49,7 +69,6 @@ namespace imageplus {
 				partition_path = (_filename_branch / partition_file).string();
 			}
 
-			std::cout << "partition " << partition_path;
 			PartitionModel partition = _read(partition_path);
 
 			if (read_mergings) {
@@ -57,24 +76,10 @@ namespace imageplus {
 				std::string image_file;
 				in_file >> image_file;
 
-				// Reading the fusions (The file must contain groups of three integers, otherwise,
-				//  the behaviour is undefined)
-				uint64 num_father, num_son1, num_son2;
-				in_file >> num_son1;
-
+				// Reading the fusions (groups of three integers)
 				_mergings.clear();
-
-				while(!in_file.eof())
-				{
-					in_file >> num_son2;
-					in_file >> num_father;
-
-					std::vector<uint64> merging(3);
-					merging[0] = num_son1; merging[1] = num_son2; merging[2] = num_father;
-					_mergings.push_back(merging);
-
-					in_file >> num_son1;
-				}
+				MergingSequenceReader mergings_reader(in_file);
+				mergings_reader.read(_mergings);
 			}
 
 			return partition;
@@ -84,181 +89,156 @@ namespace imageplus {
 			return _read(path);
 		}
 
-		std::vector<std::vector<uint64> > mergings() {
+		//! \return son1, son2 and father of every merging read by read(), in order
+		const std::vector<uint64>& mergings() const {
 			return _mergings;
 		}
 
+		//! Parses the merging sequence of the file of the last read() (which may have skipped it), without
+		//! storing it: callback(son1, son2, father) is called for every merging in order
+		//! \param[in] callback : functor receiving the mergings
+		//! \return number of mergings
+		template<class MergingCallback>
+		uint64 read_mergings(MergingCallback& callback) {
+			std::ifstream in_file(_filename.c_str(), std::ios::in);
+			if (!in_file.is_open()) throw ImagePlusFileNotFound(_filename);
+
+			// Skip the partition and image paths
+			std::string partition_file, image_file;
+			in_file >> partition_file >> image_file;
+
+			MergingSequenceReader mergings_reader(in_file);
+			return mergings_reader.for_each(callback);
+		}
+
 	private:
 
+		//! Kinds of label codes
+		enum LabelCode {
+			_label_up = 0,			//!< 0: label of the unit above
+			_label_up_right,		//!< 10: next label to the right in the row above
+			_label_next,			//!< 110: max label + 1
+			_label_explicit			//!< 111: followed by the label in num_bits bits
+		};
+
 		//!
-		//! \brief Private and overloaded method to write a MultiArray<uint32,2>
+		//! \brief Reads a PRL file, mapping it in memory and decoding it directly into the data of the partition
 		//!
-		//! \param[in]        m : partition to write
-		//! \param[in]       fp : File pointer to write data
+		//! \param[in] path : path of the file
 		//!
 		PartitionModel _read(std::string& path) {
-			// Open file
-
-			std::ifstream fp (path.c_str(), std::ios::in | std::ios::binary);
-			if (!fp.is_open())
-			{
+			boost::shared_ptr<boost::interprocess::mapped_region> region;
+			try {
+				boost::interprocess::file_mapping file(path.c_str(), boost::interprocess::read_only);
+				region.reset(new boost::interprocess::mapped_region(file, boost::interprocess::read_only));
+			} catch (boost::interprocess::interprocess_exception&) {
 				throw ImagePlusFileNotFound(path);
 			}
+			const uint8* begin = (const uint8*)region->get_address();
+			const uint8* end = begin + region->get_size();
 
-			// read magic number to start of file
-			uint16 mn;
-			fp.read((char*)&mn,sizeof(mn));
-			if (mn != 255)
-			{
-				throw;
-			}
-
-			// read filetype
-			uint8 ft;
-			fp.read((char*)&ft,sizeof(ft));
-			if (ft != 1)
-			{
-				throw;
-			}
+			// magic number, filetype, compress and datatype (1 byte each but the magic number), dimensions, size
+			// of every dimension (uint64) and number of bits of the labels (1 byte)
+			const uint64 header_size = 2 + 1 + 1 + 1 + 8 + 2*8 + 1;
+			if ((uint64)(end - begin) < header_size) throw ImagePlusFileError(path, "truncated PRL header");
 
-			// read compress
-			uint8 c;
-			fp.read((char*)&c,sizeof(c));
-			//uint64 compress = static_cast<uint64>(c);
-
-			// read datatype
-			uint8 dt;
-			fp.read((char*)&dt,sizeof(dt));
-			//uint64 datatype = static_cast<uint64>(dt);
-
-			// read dimensions
+			uint16 mn;
 			uint64 d;
-			fp.read((char*)&d,sizeof(d));
-
-			std::vector<uint64> dims(d);
-			for (uint64 i = 0; i < d; i++)
-			{
-				uint64 s;
-				fp.read((char*)&s,sizeof(s));
-				dims[i] = s;
-			}
-
-			//std::cout << mn << " " << ft << " " << d << " " << dims[0] << " " << dims[1] << std::endl;
+			uint64 dims[2];
+			std::memcpy(&mn, begin, sizeof(mn));
+			std::memcpy(&d, begin + 5, sizeof(d));
+			std::memcpy(dims, begin + 13, sizeof(dims));
+			const uint8 ft = begin[2];
+			const uint8 num_bits = begin[header_size - 1];
+
+			if (mn != 255 || ft != 1) throw ImagePlusFileError(path, "not a PRL file");
+			if (d != 2) throw ImagePlusFileError(path, "only 2D PRL partitions are supported");
+			// same limit as PRLWriter: the label code and the label are read after a single refill
+			if (num_bits > BufferBitReader::max_bits - 3) throw ImagePlusFileError(path, "too many bits per label");
 
 			PartitionModel p(dims[0],dims[1]);
-
-			_read_file(p,fp,path);
-			//std::cout << "Partition read" << std::endl;
-
+			typedef typename PartitionModel::value_data_type label_type;
+			const uint64 total = dims[0]*dims[1];
+
+			if (PartitionModel::packed) {
+				_decode(begin + header_size, end, num_bits, p.data(), dims[0], total, path);
+			} else {
+				std::vector<label_type> labels(total);
+				_decode(begin + header_size, end, num_bits, &labels[0], dims[0], total, path);
+				typename PartitionModel::iterator it = p.begin();
+				typename PartitionModel::iterator it_end = p.end();
+				for (uint64 u = 0; it != it_end; ++it, u++) (*it)(0) = labels[u];
+			}
 			return p;
 		}
 
-		void _read_file(PartitionModel& partition, std::ifstream& fp, std::string& filename) {
-
-			Partition<uint32, 2> m(partition.sizes());
-
-			uint32 *pointer = m.data();
-
-			// Read  num_bits
-			uint8 num_bits;
-			fp.read((char*)&num_bits,  1);
-
-			//std::cout << (uint64)num_bits << std::endl;
-
-			// Close the file to read it in binary
-			fp.close();
-
-			ReadBitStream<2> rbs(filename.c_str());
-
-			// Skip the header
-			rbs.seekg(112+64*2);
-
-			std::size_t total_elem = m.size_x() * m.size_y();
-			std::size_t num_read_elem = 0;
-			uint64 read_bits = 0;
-			uint32 max_label = 0;
-			uint32 current_label;
-			uint16 current_length;  // It should be uint8 but we had problems with GCC 4.3
-			std::size_t  width = m.size_x();
-
-			while(num_read_elem < total_elem)
-			{
-				//std::cout << num_read_elem << std::endl;
-				// Label casuistics
-				read_bits = rbs.read(1);
-
-				if(read_bits == 0) // "Up" value
-				{
-					current_label = *(pointer - width);
-				}
-				else
-				{
-					read_bits = rbs.read(1);
-
-					if(read_bits == 0) // "Up-one-right" value
-					{
-						const uint32 *up_value = pointer - width;
-						uint32 *up_right_value = pointer - width + 1;
-						while(*up_value == *up_right_value)
-						{
-							up_right_value++;
-						}
-						current_label = *up_right_value;
-					}
-					else
-					{
-						read_bits = rbs.read(1);
-
-						if(read_bits == 0) // "Max+1" value
-						{
-							max_label = max_label + 1;
-							current_label = max_label;
-						}
-						else
-						{
-							read_bits = rbs.read(num_bits);
-							current_label = (uint32)read_bits;
-							if(current_label>max_label)
-							{
-								max_label = current_label;
-							}
-						}
-					}
-				}
-
-				//Length casuistics
-				read_bits = rbs.read(1);
-
-				if(read_bits == 1) // 8 bits length
-				{
-					read_bits = rbs.read(8);
-					current_length = static_cast<uint8>(read_bits);
+		//!
+		//! \brief Decodes the runs of labels of a PRL bitstream, looking up the prefix codes in tables
+		//!
+		//! \param[in]  begin, end : bitstream (after the header)
+		//! \param[in]    num_bits : bits of the explicit labels
+		//! \param[out]     labels : dense array of total labels, in raster order
+		//! \param[in]       width : size of a row
+		//!
+		template<typename label_type>
+		static void _decode(const uint8* begin, const uint8* end, uint8 num_bits, label_type* labels, uint64 width, uint64 total, const std::string& path) {
+			// code and length of the label code, indexed by the next 3 bits
+			static const uint8 label_codes[8] = {_label_up, _label_up, _label_up, _label_up, _label_up_right, _label_up_right, _label_next, _label_explicit};
+			static const uint8 label_bits[8] = {1, 1, 1, 1, 2, 2, 3, 3};
+			const uint16* length_codes = prl_length_codes();
+
+			BufferBitReader reader(begin, end);
+			label_type* p = labels;
+			label_type* const p_end = labels + total;
+			label_type max_label = 0;
+			label_type label = 0;
+
+			while (p < p_end) {
+				reader.refill();
+
+				const uint64 prefix = reader.peek(3);
+				reader.skip(label_bits[prefix]);
+				switch (label_codes[prefix]) {
+				case _label_up:
+					if ((uint64)(p - labels) < width) throw ImagePlusFileError(path, "corrupted PRL bitstream");
+					label = *(p - width);
+					break;
+				case _label_up_right: {
+					if ((uint64)(p - labels) < width) throw ImagePlusFileError(path, "corrupted PRL bitstream");
+					const label_type* up = p - width;
+					const label_type* up_right = up + 1;
+					while (up_right < p && *up_right == *up) up_right++;
+					if (up_right == p) throw ImagePlusFileError(path, "corrupted PRL bitstream");
+					label = *up_right;
+					break;
 				}
-				else
-				{
-					read_bits = rbs.read(2);
-					current_length = static_cast<uint8>(read_bits) + 1;
+				case _label_next:
+					label = ++max_label;
+					break;
+				default:
+					label = (label_type)reader.read(num_bits);
+					if (label > max_label) max_label = label;
+					// the label can take all the buffered bits
+					reader.refill();
 				}
 
-				for(uint8 ii=0; ii<current_length; ii++)
-				{
-					*pointer++ = current_label;
-				}
+				// 0 + 2 bits (length 1 to 4) or 1 + 8 bits
+				const uint16 code = length_codes[reader.peek(9)];
+				reader.skip(code & 15);
+				const uint64 length = code >> 4;
+				if (length == 0 || length > (uint64)(p_end - p)) throw ImagePlusFileError(path, "corrupted PRL bitstream");
 
-				num_read_elem += current_length;
+				std::fill(p, p + length, label);
+				p += length;
 			}
 
-			typename PartitionModel::iterator p = partition.begin();
-			typename PartitionModel::iterator p_end = partition.end();
-			for (;p!=p_end;++p){
-				(*p)(0) = m(p.pos())(0);
-			}
+			if (reader.overrun()) throw ImagePlusFileError(path, "truncated PRL bitstream");
 		}
 
-
 	public:
 
-		std::vector<std::vector<uint64>>	_mergings;
+		//! son1, son2 and father of every merging
+		std::vector<uint64>	_mergings;
 
 		std::string _filename;
 
@@ -8,7 +8,10 @@
 #ifndef PARTITION2D_WRITE_HPP_
 #define PARTITION2D_WRITE_HPP_
 
+#include <imageplus/core/exceptions.hpp>
 #include <imageplus/segmentation/io/writebitstream.hpp>
+#include <cstring>
+#include <vector>
 
 namespace imageplus {
 	namespace segmentation {
@@ -27,6 +30,23 @@ namespace imageplus {
 		UINT8,INT8,UINT16,INT16,UINT32,INT32,UINT64,INT64,FLOAT32,FLOAT64,NONETYPE
 	};
 
+	//!
+	//! \brief Codes a "run-length" of PRL files: 0 + 2 bits (length - 1) up to 4, 1 + 8 bits length above
+	//!
+	//! \param[in]   length : Length to code, from 1 to 255
+	//! \param[out]     wbs : bitstream
+	//!
+	inline void write_prl_length(uint64 length, BufferBitWriter& wbs) {
+		if (length <= 4)
+		{
+			wbs.write(length - 1, 3);
+		}
+		else
+		{
+			wbs.write(256 + length, 9);
+		}
+	}
+
 	template<class PartitionModel>
 	class PRLWriter {
 
@@ -39,38 +59,47 @@ namespace imageplus {
 
 			std::ofstream fp (_filename.c_str(), std::ios::out | std::ios::binary);
 			if (!fp.is_open())
-				throw;
-
-			// write magic number to start of file
-			fp.write((char*)&MULT_MAGIC_NUMBER,sizeof(MULT_MAGIC_NUMBER));
-			if (!fp.good())
-				throw;
-
-			// write filetype to start of file
-			fp.write((char*)&MULT_FILETYPE,sizeof(MULT_FILETYPE));
-			if (!fp.good())
-				throw;
-
-			uint8 c = 1; //To make it compatible with partition run length (PRL)
-			fp.write((char*)&c,sizeof(c));
-
-			//write header
-			c = (uint8)UINT32;
-			fp.write((char*)&c,sizeof(c));
-
-			// write number of dimensions
-			uint64 d = 2;
-			fp.write((char*)&d,sizeof(uint64));
-
-			// write size of each dimension
-			for (uint32 i = 0; i < 2; i++)
-			{
-				d = partition.sizes()(i);
-				fp.write((char*)&d,sizeof(uint64));
+				throw ImagePlusFileNotFound(_filename);
+
+			// encode the labels, in place if they are stored as a dense array
+			typedef typename PartitionModel::value_data_type label_type;
+			const typename PartitionModel::coord_type sizes = partition.sizes();
+			const uint64 num_elements = sizes.prod();
+
+			BufferBitWriter wbs(num_elements / 4);
+			uint8 num_bits;
+			if (PartitionModel::packed) {
+				num_bits = _encode(static_cast<const PartitionModel&>(partition).data(), num_elements, sizes(0), wbs);
+			} else {
+				std::vector<label_type> labels(num_elements);
+				typename PartitionModel::iterator p = partition.begin();
+				typename PartitionModel::iterator p_end = partition.end();
+				for (uint64 u = 0; p != p_end; ++p, u++) labels[u] = (*p)(0);
+				num_bits = _encode(&labels[0], num_elements, sizes(0), wbs);
+			}
+			wbs.flush();
+
+			// header: magic number, filetype, compress (1, partition run length), datatype, dimensions, size of
+			// each dimension and number of bits of the labels
+			char header[2 + 1 + 1 + 1 + 8 + 2*8 + 1];
+			const uint8 c = 1;
+			const uint8 dt = (uint8)UINT32;
+			const uint64 d = 2;
+			std::memcpy(header, &MULT_MAGIC_NUMBER, 2);
+			std::memcpy(header + 2, &MULT_FILETYPE, 1);
+			std::memcpy(header + 3, &c, 1);
+			std::memcpy(header + 4, &dt, 1);
+			std::memcpy(header + 5, &d, 8);
+			for (uint64 i = 0; i < 2; i++) {
+				const uint64 s = sizes(i);
+				std::memcpy(header + 13 + 8*i, &s, 8);
 			}
+			std::memcpy(header + 29, &num_bits, 1);
 
-			// write multiarray
-			_write(partition,fp);
+			fp.write(header, sizeof(header));
+			if (wbs.size() > 0) fp.write((const char*)wbs.data(), wbs.size());
+			if (!fp.good())
+				throw ImagePlusFileError(_filename, "error writing the PRL file");
 
 			// finished
 			fp.close();
@@ -80,208 +109,103 @@ namespace imageplus {
 	private:
 
 		//!
-		//! \brief Private and overloaded method to write a MultiArray<uint32,2>
+		//! \brief Encodes the labels of a partition in runs
 		//!
-		//! \param[in]        m : partition to write
-		//! \param[in]       fp : File pointer to write data
+		//! Label codes:
+		//! 	"Up" value           -->  0
+		//! 	"Up-one-right" value -->  10
+		//! 	"Max label" +1       -->  110
+		//!  	"Label directly"     -->  111 (+ N bits of label)
+		//! followed by the length of the run (at most 255, see write_prl_length)
 		//!
-		void _write(PartitionModel& partition, std::ofstream& fp) {
-
-			Partition<uint32, 2> m(partition.sizes());
-			Partition<uint32, 2>::iterator p = m.begin();
-			Partition<uint32, 2>::iterator p_end = m.end();
-			for (;p!=p_end;++p){
-				(*p)(0) = partition(p.pos())(0);
-			}
-
-			// Pointer to the input data
-			const uint32 *input = m.data();
-
-			// Width of the multiarray
-			const uint64 width = m.size_x();
-
-			// Compute the maximum value
-			const uint64 num_elements = m.size_x() * m.size_y();
-			uint32 max_value = 0;
-			const uint32 *temp = input;
-			for(uint64 ii=0; ii<num_elements; ii++)
-			{
-				if(*temp>max_value) max_value = *temp;
-				temp++;
-			}
-
+		//! \param[in]        input : labels, as a dense array in raster order
+		//! \param[in] num_elements : number of labels
+		//! \param[in]        width : size of a row
+		//! \param[out]         wbs : bitstream
+		//! \return number of bits of the labels written directly (N)
+		//!
+		template<typename label_type>
+		static uint8 _encode(const label_type* input, uint64 num_elements, uint64 width, BufferBitWriter& wbs) {
 			// Compute the number of bits needed
-			const uint8 num_bits = (uint8)ceil(log((float64)(max_value+1))/log(2.));
-
-			// Write the number of bits used
-			fp.write((char*)&num_bits, 1);
-
-			uint32 current_label= *input;
-			uint32 max_label = current_label;
-
-			uint8  current_length = 0;
-			uint8  n_bits_to_write;
-			uint64 to_write;
+			label_type max_value = 0;
+			for (uint64 ii = 0; ii < num_elements; ii++) {
+				if (input[ii] > max_value) max_value = input[ii];
+			}
+			uint8 num_bits = 0;
+			while (num_bits < 64 && ((uint64)max_value >> num_bits) != 0) num_bits++;
+			// the label code and the label are written at once (PRLReader accepts the same number of bits)
+			if (num_bits > BufferBitWriter::max_bits - 3) throw ImagePlusError("PRLWriter: labels too big");
+			if (num_elements == 0) return num_bits;
 
-			fp.close();
+			const uint64 direct_code = (uint64)7 << num_bits;
 
-			WriteBitStream<APPEND> wbs(_filename.c_str());
+			label_type current_label = input[0];
+			label_type max_label = current_label;
+			uint64 current_length = 0;
 
 			// Write first label
-			to_write = (uint64)(((uint64)7)<<num_bits)+(uint64)current_label; // 111 + N bits label
-			n_bits_to_write = num_bits+3;
-			wbs.write(to_write, n_bits_to_write);
-
+			wbs.write(direct_code | (uint64)current_label, num_bits + 3);
 
-			for(uint64 ii=0; ii<num_elements; ii++)
+			for (uint64 ii = 0; ii < num_elements; ii++)
 			{
-				if(*input==current_label && current_length < 255)
+				if (input[ii] == current_label && current_length < 255)
 				{
 					current_length++;
+					continue;
 				}
-				else
-				{
-					// Length casuistry
-					_code_length(current_length, to_write, n_bits_to_write);
 
-					// Write length
-					wbs.write(to_write, n_bits_to_write);
+				write_prl_length(current_length, wbs);
 
-					// New label
-					current_label = *input;
-					current_length = 1;
+				// New label
+				current_label = input[ii];
+				current_length = 1;
 
-					if (ii>=width) //We are not in the first row
+				bool coded = false;
+				if (ii >= width) // We are not in the first row
+				{
+					// the label above, or the first different one to its right in the same row
+					const label_type* up = input + ii - width;
+					if (*up == current_label)
 					{
-						// Label casuistry:
-						// 	"Up" value           -->  0
-						// 	"Up-one-right" value -->  10
-						// 	"Max label" +1       -->  110
-						//  "Label directly"     -->  111 (+ N bits of label)
-						uint32 ref_label1 = *(input-width);
-						uint8 num_changes = 0;
-						bool found = false;
-						uint32 offset = 0;
-
-						do
-						{
-							uint32 ref_label2 = ref_label1;
-							ref_label1 = *(input-width+offset);
-
-							if(ref_label1 != ref_label2)
-								num_changes++;
-
-							if(ref_label1 == current_label)
-								found = true;
-
-							offset++;
-						}
-						while(num_changes<1 && ((ii+offset)%width>0) && !found);
-
-						if (found)
-						{
-							switch (num_changes)
-							{
-							case 0:
-							{
-								to_write = 0; //0
-								n_bits_to_write = 1;
-							}
-							break;
-							case 1:
-							{
-								to_write = 2; //10
-								n_bits_to_write = 2;
-							}
-							break;
-							default: // We shouldn't get here...
-							ASSERT(false, "Looking for current_label in the upper row, but something went wrong");
-							break;
-							}
-						}
-						else
-						{
-							if ((current_label-max_label)==1)
-							{
-								to_write = 6; //110
-								n_bits_to_write = 3;
-							}
-							else
-							{
-								to_write = (uint64)(((uint64)7)<<num_bits)+(uint64)current_label; // 111 + N bits label
-								n_bits_to_write = num_bits+3;
-							}
-						}
+						wbs.write(0, 1); // 0
+						coded = true;
 					}
-					else // We are in the first row, we have no "up" reference
+					else
 					{
-						if ((current_label-max_label)==1)
+						const uint64 row_end = width - ii % width;
+						uint64 offset = 1;
+						while (offset < row_end && up[offset] == *up) offset++;
+						if (offset < row_end && up[offset] == current_label)
 						{
-							to_write = 6; //110
-							n_bits_to_write = 3;
-						}
-						else
-						{
-							to_write = (uint64)(((uint64)7)<<num_bits)+(uint64)current_label; // 111 + N bits label
-							n_bits_to_write = num_bits+3;
+							wbs.write(2, 2); // 10
+							coded = true;
 						}
 					}
+				}
 
-					// Write label
-					wbs.write(to_write, n_bits_to_write);
-
-					// Update max_label
-					if(max_label<current_label)
+				if (!coded)
+				{
+					if ((label_type)(current_label - max_label) == 1)
+					{
+						wbs.write(6, 3); // 110
+					}
+					else
 					{
-						max_label = current_label;
+						wbs.write(direct_code | (uint64)current_label, num_bits + 3); // 111 + N bits label
 					}
 				}
-				input++;
+
+				// Update max_label
+				if (max_label < current_label)
+				{
+					max_label = current_label;
+				}
 			}
 
 			//Write last length
-			_code_length(current_length, to_write, n_bits_to_write);
-
-			// Actually write it
-			wbs.write(to_write, n_bits_to_write);
-			wbs.force_write();
-
-			// close the bitstream
-			wbs.close();
+			write_prl_length(current_length, wbs);
 
-		}
-
-
-		//!
-		//! \brief Private method to code a "run-length" in the ELEMENT_RUNLENGTH compression method
-		//!
-		//! \param[in]   length         : Length to code
-		//! \param[in]   to_write       : Coded binary stream
-		//! \param[in]   n_bits_to_write: Number of bits to be written
-		//!
-		void _code_length(const uint8& length, uint64& to_write, uint8& n_bits_to_write) {
-			switch (length)
-			{
-			case 1:
-				to_write = 0; //000
-				n_bits_to_write = 3;
-				break;
-			case 2:
-				to_write = 1; //001
-				n_bits_to_write = 3;
-				break;
-			case 3:
-				to_write = 2; //010
-				n_bits_to_write = 3;
-				break;
-			case 4:
-				to_write = 3; //011
-				n_bits_to_write = 3;
-				break;
-			default:  // >4
-				to_write = (uint64)256+(uint64)length; //1 + 8 bits length
-				n_bits_to_write = 9;
-			}
+			return num_bits;
 		}
 
 	public:
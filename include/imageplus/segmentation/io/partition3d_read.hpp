@@ -0,0 +1,287 @@
+/*
+ * partition3d_read.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef PARTITION3D_READ_HPP_
+#define PARTITION3D_READ_HPP_
+
+#include <imageplus/core/exceptions.hpp>
+#include <imageplus/segmentation/io/partition2d_read.hpp>
+#include <imageplus/segmentation/io/partition3d_write.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/static_assert.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+	//!
+	//! \brief Reader of 3D partitions written with PRL3DWriter
+	//!
+	//! The file is mapped in memory when it is opened, and the whole partition or single frames are decoded
+	//! from the mapping. Decoding a frame decodes the frames from the previous key frame. Opening a file checks
+	//! its header and its table of frames, and decoding checks the bitstreams.
+	//!
+	template<class PartitionModel>
+	class PRL3DReader {
+
+	public:
+
+		typedef typename PartitionModel::value_data_type	label_type;
+		typedef typename PartitionModel::coord_type			coord_type;
+
+		//! Default constructor, open() must be called before reading
+		PRL3DReader() : _header(NULL) {
+		}
+
+		//!
+		//! \brief Constructor opening a file
+		//!
+		//! \param[in] filename : file written with PRL3DWriter
+		//!
+		PRL3DReader(std::string filename) : _header(NULL) {
+			open(filename);
+		}
+
+		//!
+		//! \brief Maps a file and checks its header
+		//!
+		//! \param[in] filename : file written with PRL3DWriter
+		//!
+		void open(std::string filename) {
+			boost::shared_ptr<boost::interprocess::mapped_region> region;
+			try {
+				boost::interprocess::file_mapping file(filename.c_str(), boost::interprocess::read_only);
+				region.reset(new boost::interprocess::mapped_region(file, boost::interprocess::read_only));
+			} catch (boost::interprocess::interprocess_exception&) {
+				throw ImagePlusFileNotFound(filename);
+			}
+
+			const uint8* begin = (const uint8*)region->get_address();
+			const PRL3DHeader* header = (const PRL3DHeader*)begin;
+			if (region->get_size() < sizeof(PRL3DHeader) || !header->is_valid())
+				throw ImagePlusFileError(filename, "not a 3D partition of this version and byte order");
+
+			// same limit as PRL3DWriter: the label code and the label are read after a single refill
+			if (header->num_bits > BufferBitReader::max_bits - 5)
+				throw ImagePlusFileError(filename, "too many bits per label");
+			if (header->key_interval == 0)
+				throw ImagePlusFileError(filename, "invalid key interval");
+
+			// the table must fit in the file, and the bitstreams of the frames must follow it in order
+			const uint64 num_frames = header->sizes[2];
+			const uint64 file_size = region->get_size();
+			if (file_size < sizeof(PRL3DHeader) + sizeof(uint64) || num_frames > (file_size - sizeof(PRL3DHeader) - sizeof(uint64)) / (2*sizeof(uint64)))
+				throw ImagePlusFileError(filename, "truncated 3D partition");
+			const uint64* table = (const uint64*)(begin + sizeof(PRL3DHeader));
+			const uint64 data_offset = sizeof(PRL3DHeader) + (2*num_frames + 1)*sizeof(uint64);
+			if (table[0] < data_offset || table[2*num_frames] > file_size)
+				throw ImagePlusFileError(filename, "truncated 3D partition");
+			for (uint64 f = 0; f < num_frames; f++) {
+				if (table[2*f + 2] < table[2*f])
+					throw ImagePlusFileError(filename, "corrupted 3D partition table");
+			}
+
+			_filename = filename;
+			_region = region;
+			_header = header;
+			_table = table;
+			_begin = begin;
+		}
+
+		//! \return size in x, y and number of frames
+		coord_type sizes() const {
+			return coord_type(_header->sizes[0], _header->sizes[1], _header->sizes[2]);
+		}
+
+		//! \return number of frames
+		uint64 num_frames() const {
+			return _header->sizes[2];
+		}
+
+		//! \return size in bytes of the bitstream of a frame
+		uint64 frame_bytes(uint64 frame) const {
+			return _table[2*frame + 2] - _table[2*frame];
+		}
+
+		//!
+		//! \brief Decodes the whole partition
+		//!
+		//! \return the partition
+		//!
+		PartitionModel read() {
+			// the frames are decoded in place
+			BOOST_STATIC_ASSERT(PartitionModel::coord_dimensions == 3 && PartitionModel::packed);
+
+			PartitionModel p(_header->sizes[0], _header->sizes[1], _header->sizes[2]);
+			const uint64 frame_size = _header->sizes[0]*_header->sizes[1];
+			label_type* labels = p.data();
+			for (uint64 f = 0; f < num_frames(); f++) {
+				_decode_frame(f, (f % _header->key_interval == 0) ? NULL : labels + (f-1)*frame_size, labels + f*frame_size);
+			}
+			return p;
+		}
+
+		//!
+		//! \brief Decodes a frame
+		//!
+		//! \param[in]  frame : index of the frame
+		//! \param[out] labels : dense array of size x * size y labels of the frame, in raster order
+		//!
+		void read_frame(uint64 frame, label_type* labels) {
+			if (frame >= num_frames()) throw ImagePlusError("PRL3DReader: frame out of range");
+
+			const uint64 frame_size = _header->sizes[0]*_header->sizes[1];
+			const uint64 key = frame - frame % _header->key_interval;
+			if (key == frame) {
+				_decode_frame(frame, NULL, labels);
+				return;
+			}
+
+			// decode from the key frame, alternating two frames so the last one is decoded in labels
+			std::vector<label_type> buffer(frame_size);
+			label_type* frames[2] = {labels, &buffer[0]};
+			uint64 current = (frame - key) % 2;
+			_decode_frame(key, NULL, frames[current]);
+			for (uint64 f = key + 1; f <= frame; f++) {
+				_decode_frame(f, frames[current], frames[1 - current]);
+				current = 1 - current;
+			}
+		}
+
+		//!
+		//! \brief Decodes a frame
+		//!
+		//! \param[in] frame : index of the frame
+		//! \return the frame as a 2D partition (e.g. Partition<uint64,2>)
+		//!
+		template<class FrameModel>
+		FrameModel read_frame(uint64 frame) {
+			BOOST_STATIC_ASSERT(FrameModel::coord_dimensions == 2 && FrameModel::packed);
+			BOOST_STATIC_ASSERT(sizeof(typename FrameModel::value_data_type) == sizeof(label_type));
+
+			FrameModel p(_header->sizes[0], _header->sizes[1]);
+			read_frame(frame, (label_type*)p.data());
+			return p;
+		}
+
+	private:
+
+		//! Kinds of label codes
+		enum LabelCode {
+			_label_up = 0,			//!< 0: label of the unit above
+			_copy_previous,			//!< 10: labels of the units in the previous frame
+			_label_previous,		//!< 110: label of the unit in the previous frame
+			_label_up_right,		//!< 1110: next label to the right in the row above
+			_label_next,			//!< 11110: max label + 1
+			_label_explicit			//!< 11111: followed by the label in num_bits bits
+		};
+
+		//!
+		//! \brief Decodes the runs of a frame, looking up the prefix codes in tables
+		//!
+		//! \param[in]    frame : index of the frame
+		//! \param[in] previous : labels of the previous frame, or NULL for key frames
+		//! \param[out]  labels : labels of the frame
+		//!
+		void _decode_frame(uint64 frame, const label_type* previous, label_type* labels) {
+			// code and length of the run code, indexed by the next 5 bits
+			static const uint8 label_codes[32] = {_label_up, _label_up, _label_up, _label_up, _label_up, _label_up, _label_up, _label_up,
+												  _label_up, _label_up, _label_up, _label_up, _label_up, _label_up, _label_up, _label_up,
+												  _copy_previous, _copy_previous, _copy_previous, _copy_previous, _copy_previous, _copy_previous, _copy_previous, _copy_previous,
+												  _label_previous, _label_previous, _label_previous, _label_previous, _label_up_right, _label_up_right, _label_next, _label_explicit};
+			static const uint8 label_bits[32] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 5, 5};
+			const uint16* length_codes = prl_length_codes();
+
+			const uint64 width = _header->sizes[0];
+			const uint64 total = _header->sizes[0]*_header->sizes[1];
+			const uint8 num_bits = (uint8)_header->num_bits;
+
+			BufferBitReader reader(_begin + _table[2*frame], _begin + _table[2*frame + 2]);
+			label_type* p = labels;
+			label_type* const p_end = labels + total;
+			label_type max_label = (label_type)_table[2*frame + 1];
+			label_type label = 0;
+
+			while (p < p_end) {
+				reader.refill();
+
+				const uint64 prefix = reader.peek(5);
+				reader.skip(label_bits[prefix]);
+				const uint8 kind = label_codes[prefix];
+				switch (kind) {
+				case _label_up:
+					if ((uint64)(p - labels) < width) throw ImagePlusFileError(_filename, "corrupted 3D partition");
+					label = *(p - width);
+					break;
+				case _copy_previous:
+				case _label_previous:
+					if (previous == NULL) throw ImagePlusFileError(_filename, "corrupted 3D partition");
+					label = previous[p - labels];
+					break;
+				case _label_up_right: {
+					if ((uint64)(p - labels) < width) throw ImagePlusFileError(_filename, "corrupted 3D partition");
+					const label_type* up = p - width;
+					const label_type* up_right = up + 1;
+					while (up_right < p && *up_right == *up) up_right++;
+					if (up_right == p) throw ImagePlusFileError(_filename, "corrupted 3D partition");
+					label = *up_right;
+					break;
+				}
+				case _label_next:
+					label = ++max_label;
+					break;
+				default:
+					label = (label_type)reader.read(num_bits);
+					if (label > max_label) max_label = label;
+					// the label can take all the buffered bits
+					reader.refill();
+				}
+
+				const uint16 code = length_codes[reader.peek(9)];
+				reader.skip(code & 15);
+				const uint64 length = code >> 4;
+				if (length == 0 || length > (uint64)(p_end - p)) throw ImagePlusFileError(_filename, "corrupted 3D partition");
+
+				if (kind == _copy_previous) {
+					const label_type* source = previous + (p - labels);
+					for (uint64 i = 0; i < length; i++) {
+						if (source[i] > max_label) max_label = source[i];
+					}
+					std::copy(source, source + length, p);
+				} else {
+					std::fill(p, p + length, label);
+				}
+				p += length;
+			}
+
+			if (reader.overrun()) throw ImagePlusFileError(_filename, "truncated 3D partition");
+		}
+
+		//! path of the file
+		std::string _filename;
+
+		//! mapping of the file
+		boost::shared_ptr<boost::interprocess::mapped_region> _region;
+
+		//! header at the beginning of the mapping
+		const PRL3DHeader* _header;
+
+		//! offset and max label before every frame
+		const uint64* _table;
+
+		//! beginning of the mapping
+		const uint8* _begin;
+	};
+
+	}
+}
+
+#endif /* PARTITION3D_READ_HPP_ */
@@ -0,0 +1,250 @@
+/*
+ * partition3d_write.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef PARTITION3D_WRITE_HPP_
+#define PARTITION3D_WRITE_HPP_
+
+#include <imageplus/core/exceptions.hpp>
+#include <imageplus/segmentation/io/partition2d_write.hpp>
+#include <boost/static_assert.hpp>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+	//!
+	//! \brief Header of the compressed 3D partition files (see PRL3DWriter)
+	//!
+	//! The header is followed by a table with the offset in bytes from the beginning of the file and the max
+	//! label before every frame (two uint64 per frame) plus the end of the last frame, and by the bitstream of
+	//! every frame, starting at a byte. All the fields are in the byte order of the machine that wrote the file.
+	//!
+	struct PRL3DHeader {
+
+		static const uint32 current_version = 1;
+		static const uint32 byte_order_mark = 0x01020304;
+
+		//! "IPPRL3D" followed by a zero
+		char magic[8];
+
+		//! format version
+		uint32 version;
+
+		//! byte_order_mark written in the byte order of the file
+		uint32 byte_order;
+
+		//! size in x, y and number of frames
+		uint64 sizes[3];
+
+		//! bits of the labels written directly
+		uint64 num_bits;
+
+		//! every key_interval frames there is a frame coded without the previous one
+		uint64 key_interval;
+
+		//! highest label
+		uint64 max_label;
+
+		//! \return true if the magic, version and byte order are the ones of this implementation
+		bool is_valid() const {
+			return std::memcmp(magic, "IPPRL3D", 8) == 0 && version == current_version && byte_order == byte_order_mark;
+		}
+	};
+
+	//!
+	//! \brief Writer of 3D partitions (e.g. supervoxels of a video) compressed frame by frame, extending the PRL format
+	//!
+	//! Every frame is coded in runs in raster order, as in PRL files, and every run is coded with a prefix code
+	//! followed by its length (see write_prl_length). A run either copies the units at the same positions in
+	//! the previous frame or has a single label, predicted from the unit above, from the unit at the same
+	//! position in the previous frame, from the row above or from the highest label:
+	//! 	"Up" value              -->  0
+	//! 	"Copy previous frame"   -->  10
+	//! 	"Previous frame" value  -->  110
+	//! 	"Up-one-right" value    -->  1110
+	//! 	"Max label" +1          -->  11110
+	//!  	"Label directly"        -->  11111 (+ N bits of label)
+	//!
+	//! Frames multiple of the key interval are coded without the previous frame, so a frame can be decoded
+	//! decoding at most key_interval frames (all the frames are independent with key_interval = 1).
+	//!
+	template<class PartitionModel>
+	class PRL3DWriter {
+
+	public:
+
+		typedef typename PartitionModel::value_data_type	label_type;
+
+		//!
+		//! \brief Constructor
+		//!
+		//! \param[in] key_interval : frames between frames coded without the previous one
+		//!
+		PRL3DWriter(uint64 key_interval = 16) : _key_interval(key_interval == 0 ? 1 : key_interval) {
+		}
+
+		//!
+		//! \brief Writes a 3D partition
+		//!
+		//! \param[in] partition : partition to write (the frames are the slices of the third dimension)
+		//! \param[in]  filename : path of the file
+		//!
+		void write(PartitionModel& partition, std::string filename) {
+			// the frames are read as dense arrays
+			BOOST_STATIC_ASSERT(PartitionModel::coord_dimensions == 3 && PartitionModel::packed);
+
+			const typename PartitionModel::coord_type sizes = partition.sizes();
+			const uint64 width = sizes(0);
+			const uint64 frame_size = sizes(0)*sizes(1);
+			const uint64 num_frames = sizes(2);
+			const label_type* labels = static_cast<const PartitionModel&>(partition).data();
+
+			// Compute the number of bits needed
+			label_type max_value = 0;
+			for (uint64 u = 0; u < frame_size*num_frames; u++) {
+				if (labels[u] > max_value) max_value = labels[u];
+			}
+			uint8 num_bits = 0;
+			while (num_bits < 64 && ((uint64)max_value >> num_bits) != 0) num_bits++;
+			// the label code and the label are written at once (PRL3DReader accepts the same number of bits)
+			if (num_bits > BufferBitWriter::max_bits - 5) throw ImagePlusError("PRL3DWriter: labels too big");
+
+			PRL3DHeader header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, "IPPRL3D", 8);
+			header.version = PRL3DHeader::current_version;
+			header.byte_order = PRL3DHeader::byte_order_mark;
+			for (uint64 k = 0; k < 3; k++) header.sizes[k] = sizes(k);
+			header.num_bits = num_bits;
+			header.key_interval = _key_interval;
+			header.max_label = max_value;
+
+			// frames
+			std::vector<uint64> table(2*num_frames + 1);
+			BufferBitWriter wbs(frame_size*num_frames / 16);
+			const uint64 data_offset = sizeof(PRL3DHeader) + table.size()*sizeof(uint64);
+			label_type max_label = 0;
+			for (uint64 f = 0; f < num_frames; f++) {
+				table[2*f] = data_offset + wbs.size();
+				table[2*f + 1] = max_label;
+				const label_type* previous = (f % _key_interval == 0) ? NULL : labels + (f-1)*frame_size;
+				_encode_frame(labels + f*frame_size, previous, frame_size, width, num_bits, max_label, wbs);
+				wbs.flush();
+			}
+			table[2*num_frames] = data_offset + wbs.size();
+
+			std::ofstream fp(filename.c_str(), std::ios::out | std::ios::binary);
+			if (!fp.is_open())
+				throw ImagePlusFileNotFound(filename);
+
+			fp.write((const char*)&header, sizeof(header));
+			fp.write((const char*)&table[0], table.size()*sizeof(uint64));
+			if (wbs.size() > 0) fp.write((const char*)wbs.data(), wbs.size());
+			if (!fp.good())
+				throw ImagePlusFileError(filename, "error writing the 3D partition");
+		}
+
+	private:
+
+		//!
+		//! \brief Encodes the runs of a frame
+		//!
+		//! \param[in]         input : labels of the frame, in raster order
+		//! \param[in]      previous : labels of the previous frame, or NULL for key frames
+		//! \param[in]  num_elements : number of units of the frame
+		//! \param[in]         width : size of a row
+		//! \param[in]      num_bits : bits of the labels written directly
+		//! \param[in,out] max_label : highest label coded so far
+		//! \param[out]          wbs : bitstream
+		//!
+		static void _encode_frame(const label_type* input, const label_type* previous, uint64 num_elements, uint64 width, uint8 num_bits, label_type& max_label, BufferBitWriter& wbs) {
+			const uint64 direct_code = (uint64)31 << num_bits;
+
+			uint64 ii = 0;
+			while (ii < num_elements)
+			{
+				const label_type current_label = input[ii];
+				uint64 current_length = 1;
+				while (ii + current_length < num_elements && current_length < 255 && input[ii + current_length] == current_label) current_length++;
+
+				// copy the previous frame if it covers more units than the label
+				if (previous != NULL)
+				{
+					uint64 copy_length = 0;
+					while (ii + copy_length < num_elements && copy_length < 255 && input[ii + copy_length] == previous[ii + copy_length]) copy_length++;
+					if (copy_length > current_length)
+					{
+						wbs.write(2, 2); // 10
+						write_prl_length(copy_length, wbs);
+						for (uint64 i = ii; i < ii + copy_length; i++)
+						{
+							if (max_label < input[i]) max_label = input[i];
+						}
+						ii += copy_length;
+						continue;
+					}
+				}
+
+				bool coded = false;
+				const label_type* up = (ii >= width) ? input + ii - width : NULL;
+				if (up != NULL && *up == current_label)
+				{
+					wbs.write(0, 1); // 0
+					coded = true;
+				}
+				else if (previous != NULL && previous[ii] == current_label)
+				{
+					wbs.write(6, 3); // 110
+					coded = true;
+				}
+				else if (up != NULL)
+				{
+					// first different label to the right of the one above, in the same row
+					const uint64 row_end = width - ii % width;
+					uint64 offset = 1;
+					while (offset < row_end && up[offset] == *up) offset++;
+					if (offset < row_end && up[offset] == current_label)
+					{
+						wbs.write(14, 4); // 1110
+						coded = true;
+					}
+				}
+
+				if (!coded)
+				{
+					if ((uint64)current_label == (uint64)max_label + 1)
+					{
+						wbs.write(30, 5); // 11110
+					}
+					else
+					{
+						wbs.write(direct_code | (uint64)current_label, num_bits + 5); // 11111 + N bits label
+					}
+				}
+
+				// Update max_label
+				if (max_label < current_label)
+				{
+					max_label = current_label;
+				}
+
+				write_prl_length(current_length, wbs);
+				ii += current_length;
+			}
+		}
+
+		//! frames between key frames
+		uint64 _key_interval;
+	};
+
+	}
+}
+
+#endif /* PARTITION3D_WRITE_HPP_ */
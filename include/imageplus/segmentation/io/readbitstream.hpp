@@ -240,6 +240,117 @@ namespace imageplus
     	//! Stores the current number of bits left to read in the buffer
     	uint8 _bits_left;
     };
+
+    //!
+    //! \brief Class for reading bitstreams from memory, most significant bit first (as written by WriteBitStream)
+    //!
+    //! The next bits are kept in a 64-bit buffer, refilled with whole words, so codes can be decoded looking up
+    //! the next bits in a table (peek) and then skipping the bits of the code. Bits past the end read as zeros.
+    //!
+    //! Usage:
+    //! \code
+    //!    BufferBitReader reader(data, data + size);
+    //!    reader.refill();
+    //!    uint64 code = reader.peek(3);
+    //!    reader.skip(table[code].bits);
+    //! \endcode
+    //!
+    class BufferBitReader
+    {
+    public:
+
+    	//! Bits that can be peeked or skipped after a refill
+    	static const uint8 max_bits = 56;
+
+    	//!
+    	//! \brief Constructor
+    	//!
+    	//! \param[in] begin : First byte of the bitstream
+    	//! \param[in] end : End of the bitstream
+    	//!
+    	BufferBitReader(const uint8* begin, const uint8* end) : _next(begin), _end(end), _buffer(0), _bits(0), _overrun(0) {
+    	}
+
+    	//!
+    	//! \brief Fills the buffer with at least max_bits bits
+    	//!
+    	inline void refill() {
+    		if (_end - _next >= 8) {
+    			// load 8 bytes and keep the whole ones that fit after the buffered bits
+    			uint64 word = 0;
+    			for (uint64 i = 0; i < 8; i++) word = (word << 8) | _next[i];
+    			_buffer |= word >> _bits;
+    			_next += (63 - _bits) >> 3;
+    			_bits |= 56;
+    		} else {
+    			while (_bits <= 56) {
+    				if (_next < _end) {
+    					_buffer |= (uint64)*_next++ << (56 - _bits);
+    				} else {
+    					_overrun += 8;
+    				}
+    				_bits += 8;
+    			}
+    		}
+    	}
+
+    	//!
+    	//! \brief Returns the next bits without moving the pointer (at most max_bits since the last refill)
+    	//!
+    	//! \param[in] n_bits : Number of bits, from 1 to 56
+    	//! \return The bits in the low significance part
+    	//!
+    	inline uint64 peek(uint8 n_bits) const {
+    		return _buffer >> (64 - n_bits);
+    	}
+
+    	//!
+    	//! \brief Moves the pointer (at most max_bits since the last refill)
+    	//!
+    	//! \param[in] n_bits : Number of bits
+    	//!
+    	inline void skip(uint8 n_bits) {
+    		_buffer <<= n_bits;
+    		_bits -= n_bits;
+    	}
+
+    	//!
+    	//! \brief Reads the next bits (at most max_bits since the last refill)
+    	//!
+    	//! \param[in] n_bits : Number of bits, from 0 to 56
+    	//! \return The bits in the low significance part
+    	//!
+    	inline uint64 read(uint8 n_bits) {
+    		if (n_bits == 0) return 0;
+    		uint64 bits = peek(n_bits);
+    		skip(n_bits);
+    		return bits;
+    	}
+
+    	//!
+    	//! \return true if more bits have been read than the ones in the bitstream
+    	//!
+    	bool overrun() const {
+    		return _overrun > _bits;
+    	}
+
+    private:
+
+    	//! Next byte to load in the buffer
+    	const uint8* _next;
+
+    	//! End of the bitstream
+    	const uint8* _end;
+
+    	//! Next bits, from the most significant one
+    	uint64 _buffer;
+
+    	//! Number of valid bits in _buffer
+    	uint8 _bits;
+
+    	//! Number of zero bits loaded past the end
+    	uint64 _overrun;
+    };
     } // namespace segmentation
 } //namespace imageplus
 
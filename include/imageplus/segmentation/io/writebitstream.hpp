@@ -11,6 +11,8 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
+#include <imageplus/core/imageplus_types.hpp>
 
 
 namespace imageplus
@@ -218,6 +220,98 @@ namespace imageplus
                 //! Stores the current free space in the buffer
                 uint8 _space;
         };
+
+        //!
+        //! \brief Class for writing bitstreams to memory, most significant bit first (as read by BufferBitReader)
+        //!
+        //! The bits are accumulated in a 64-bit register and moved to the buffer a byte at a time only when the
+        //! register is full, so the bitstream can be written to disk at once.
+        //!
+        //! Usage:
+        //! \code
+        //!    BufferBitWriter writer;
+        //!    writer.write(10, 4); // 1010
+        //!     //...
+        //!    writer.flush();
+        //!    fp.write((const char*)writer.data(), writer.size());
+        //! \endcode
+        //!
+        class BufferBitWriter
+        {
+            public:
+
+                //! Bits that can be written at once
+                static const uint8 max_bits = 56;
+
+                //!
+                //! \brief Constructor
+                //!
+                //! \param[in] capacity : Bytes to reserve in the buffer
+                //!
+                explicit BufferBitWriter(uint64 capacity = 0) : _register(0), _bits(0) {
+                	_data.reserve(capacity);
+                }
+
+                //!
+                //! \brief Writes the specified number of bits
+                //!
+                //! \param[in] to_write: Number to be written (the upper bits from n_bits_to_write are ignored)
+                //! \param[in] n_bits_to_write: Number of bits from \b to_write to be written, at most max_bits
+                //!
+                inline void write( uint64 to_write, uint8 n_bits_to_write ) {
+                	if (n_bits_to_write == 0) return;
+                	if (_bits + n_bits_to_write > 64) _drain();
+                	to_write &= ~(uint64)0 >> (64 - n_bits_to_write);
+                	_register |= to_write << (64 - _bits - n_bits_to_write);
+                	_bits += n_bits_to_write;
+                }
+
+                //!
+                //! \brief Moves the bits in the register to the buffer, adding zeros up to a byte
+                //!
+                void flush( ) {
+                	_drain();
+                	if (_bits > 0) {
+                		_data.push_back((uint8)(_register >> 56));
+                		_register = 0;
+                		_bits = 0;
+                	}
+                }
+
+                //!
+                //! \return Bytes of the buffer (call flush first to include the last bits)
+                //!
+                const uint8* data( ) const {
+                	return _data.empty() ? NULL : &_data[0];
+                }
+
+                //!
+                //! \return Number of bytes of the buffer
+                //!
+                uint64 size( ) const {
+                	return _data.size();
+                }
+
+            private:
+
+                //! Moves the whole bytes of the register to the buffer
+                inline void _drain( ) {
+                	while (_bits >= 8) {
+                		_data.push_back((uint8)(_register >> 56));
+                		_register <<= 8;
+                		_bits -= 8;
+                	}
+                }
+
+                //! Bytes written
+                std::vector<uint8> _data;
+
+                //! Next bits to write, from the most significant one
+                uint64 _register;
+
+                //! Number of bits in _register
+                uint8 _bits;
+        };
     } // namespace segmentation
 } //namespace imageplus
 
@@ -11,37 +11,41 @@
 namespace imageplus {
 	namespace segmentation {
 
+	//! Functor counting the groundtruth contours and the ones also found in the partition
 	template<class PartitionModel>
-	float64 boundary_recall(PartitionModel& partition, PartitionModel& groundtruth) {
-
-		float64 groundtruth_contours = 0;
-		float64 true_positives = 0;
-
-		typename PartitionModel::iterator p = partition.begin();
-		typename PartitionModel::iterator end = partition.end();
-
-		typedef typename PartitionModel::template general_adjacency_iterator<PartitionModel::default_forward_connectivity>::type  adj_iterator;
-		for (; p != end; ++p) {
-			typename PartitionModel::coord_type pos = p.pos();
-			adj_iterator adj		 	= partition.template general_adjacency_begin<PartitionModel::default_forward_connectivity>(p.pos());
-			adj_iterator adj_end 		= partition.template general_adjacency_end<PartitionModel::default_forward_connectivity>(p.pos());
-
-			uint64 label 	= (*p)(0);
-			uint64 label_gt = groundtruth(pos)(0);
-
-			for (; adj!=adj_end;++adj) {
-				uint64 label_adj 		= (*adj)(0);
-				uint64 label_adj_gt 	= groundtruth(adj.pos())(0);
-				if (label_gt != label_adj_gt) {
-					groundtruth_contours++;
-					if (label_adj !=label) {
-						true_positives++;
-					}
+	struct boundary_recall_counter {
+
+		typedef typename PartitionModel::value_data_type label_type;
+
+		const label_type* partition;
+		const label_type* groundtruth;
+
+		float64 groundtruth_contours;
+		float64 true_positives;
+
+		boundary_recall_counter(const label_type* p, const label_type* gt) : partition(p), groundtruth(gt), groundtruth_contours(0), true_positives(0) {
+		}
+
+		inline void operator()(uint64 unit, uint64 neighbor) {
+			if (groundtruth[unit] != groundtruth[neighbor]) {
+				groundtruth_contours++;
+				if (partition[unit] != partition[neighbor]) {
+					true_positives++;
 				}
 			}
 		}
+	};
+
+	//! Fraction of the groundtruth contours found in the partition. Both partitions are only read, so shared data
+	//! is not copied.
+	template<class PartitionModel>
+	float64 boundary_recall(const PartitionModel& partition, const PartitionModel& groundtruth) {
+
+		boundary_recall_counter<PartitionModel> counter(partition.data(), groundtruth.data());
+
+		scan_adjacencies<PartitionModel::default_forward_connectivity>(partition, counter);
 
-		return true_positives / groundtruth_contours;
+		return counter.true_positives / counter.groundtruth_contours;
 	}
 
 	}
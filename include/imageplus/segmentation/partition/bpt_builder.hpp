@@ -0,0 +1,249 @@
+/*
+ * bpt_builder.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef BPT_BUILDER_HPP_
+#define BPT_BUILDER_HPP_
+
+#include <imageplus/core/b_search_tree.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/leaf_scan.hpp>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Stop criterion of BPTBuilder: merges until a number of regions is reached
+		struct StopAtNumberOfRegions {
+
+			//! Constructor
+			//! \param[in] n : number of regions where the merging stops (1 builds the whole tree)
+			StopAtNumberOfRegions(uint64 n = 1) : num_regions(n) {
+			}
+
+			//! \param[in] regions : current number of regions
+			//! \param[in] distance : distance of the next merging
+			//! \return true to stop merging
+			inline bool operator()(uint64 regions, float64 /*distance*/) const {
+				return regions <= num_regions;
+			}
+
+			//! number of regions where the merging stops
+			uint64 num_regions;
+		};
+
+		//! Stop criterion of BPTBuilder: merges while the distance of the closest regions is below a threshold
+		struct StopAtDistance {
+
+			//! Constructor
+			//! \param[in] d : maximum distance of a merging
+			StopAtDistance(float64 d) : max_distance(d) {
+			}
+
+			//! \param[in] regions : current number of regions
+			//! \param[in] distance : distance of the next merging
+			//! \return true to stop merging
+			inline bool operator()(uint64 /*regions*/, float64 distance) const {
+				return distance > max_distance;
+			}
+
+			//! maximum distance of a merging
+			float64 max_distance;
+		};
+
+		//! Link distance of BPTBuilder based on the mean value of the regions (Ward criterion: increase of the squared error).
+		//! Areas and sums of the values of the regions are kept by label and combined at every merging.
+		template<class RegionModel, class SignalModel>
+		class MeanValueDistance {
+		public:
+
+			static const uint64 channels = SignalModel::value_dimensions;
+
+			//! Constructor
+			//! \param[in] leaves : leaves partition, labelled from 0 (e.g. HierarchicalRegionPartition::leaves_partition())
+			//! \param[in] img : image, with the same domain as leaves
+			//! \param[in] num_leaves : number of leaves
+			template<class PartitionModel>
+			MeanValueDistance(PartitionModel& leaves, SignalModel& img, uint64 num_leaves) : _area(2*num_leaves, 0), _sum(2*num_leaves*channels, 0) {
+				_accumulator accumulator(*this);
+				scan_leaves(leaves, img, accumulator);
+			}
+
+			//! Distance between two neighboring regions
+			inline float64 operator()(RegionModel& r1, RegionModel& r2) const {
+				const uint64 l1 = r1.label();
+				const uint64 l2 = r2.label();
+				const float64 a1 = _area[l1];
+				const float64 a2 = _area[l2];
+
+				float64 d = 0;
+				for (uint64 c = 0; c < channels; c++) {
+					float64 diff = _sum[l1*channels + c]/a1 - _sum[l2*channels + c]/a2;
+					d += diff*diff;
+				}
+				return d * (a1*a2) / (a1 + a2);
+			}
+
+			//! Combines the statistics of two merged regions
+			inline void merge(RegionModel& parent, RegionModel& r1, RegionModel& r2) {
+				const uint64 l = parent.label();
+				_area[l] = _area[r1.label()] + _area[r2.label()];
+				for (uint64 c = 0; c < channels; c++) _sum[l*channels + c] = _sum[r1.label()*channels + c] + _sum[r2.label()*channels + c];
+			}
+
+		protected:
+
+			//! Adds every unit of the leaves to the statistics of its label (see scan_leaves)
+			struct _accumulator {
+
+				MeanValueDistance& distance;
+
+				_accumulator(MeanValueDistance& d) : distance(d) {
+				}
+
+				inline void operator()(uint64 l, const typename SignalModel::value_data_type* values, const int64* /*pos*/) {
+					distance._area[l]++;
+					for (uint64 c = 0; c < channels; c++) distance._sum[l*channels + c] += values[c];
+				}
+			};
+
+			//! area of every region
+			std::vector<float64> _area;
+
+			//! sum of the values of every region
+			std::vector<float64> _sum;
+		};
+
+		//! Builds a Binary Partition Tree merging iteratively the two neighboring regions with the lowest link distance.
+		//! The links between regions (RegionDistanceLink) are kept sorted in an AVL tree (BST). After every merging only the
+		//! links of the merged regions are removed from the tree, and only the links of the new region are scored and inserted.
+		//!
+		//! DistanceModel must provide:
+		//! 	- float64 operator()(RegionType& r1, RegionType& r2) : distance of the link between two neighboring regions
+		//! 	- void merge(RegionType& parent, RegionType& r1, RegionType& r2) : called before scoring the links of a new region
+		//!
+		//! StopModel is called as bool stop(num_regions, distance) before every merging (see StopAtNumberOfRegions).
+		//!
+		//! Links with the same distance are merged in order of the labels of their regions, so the tree does not depend on
+		//! the addresses where the regions are allocated.
+		template<class HierarchyModel, class DistanceModel>
+		class BPTBuilder {
+		public:
+
+			typedef typename HierarchyModel::RegionType							RegionType;
+			typedef typename RegionType::RegionBaseType							RegionBaseType;
+			typedef typename RegionType::RegionLinkType							RegionLinkType;
+
+			//! Orders the links by distance, and the links with the same distance by the labels of their regions
+			struct compare_distance_and_labels {
+				inline bool operator()(RegionLinkType* a, RegionLinkType* b) const {
+					if (a->distance != b->distance) return a->distance < b->distance;
+					const uint64 a1 = a->neighbor1->label(), a2 = a->neighbor2->label();
+					const uint64 b1 = b->neighbor1->label(), b2 = b->neighbor2->label();
+					const uint64 a_low = (a1 < a2) ? a1 : a2, a_high = (a1 < a2) ? a2 : a1;
+					const uint64 b_low = (b1 < b2) ? b1 : b2, b_high = (b1 < b2) ? b2 : b1;
+					if (a_low != b_low) return a_low < b_low;
+					return a_high < b_high;
+				}
+			};
+
+			typedef BST<RegionLinkType, compare_distance_and_labels>			QueueType;
+
+			//! Constructor
+			//! \param[in] hierarchy : hierarchy initialized with the leaves (HierarchicalRegionPartition::init)
+			//! \param[in] distance : link distance
+			BPTBuilder(HierarchyModel& hierarchy, DistanceModel& distance) : _hierarchy(hierarchy), _distance(distance) {
+			}
+
+			//! Merges regions until the stop criterion is fulfilled or there are no more links
+			//! \param[in] stop : stop criterion
+			//! \return number of mergings
+			template<class StopModel>
+			uint64 build(StopModel stop) {
+				uint64 num_leaves = _hierarchy.max_label() + 1;
+				_hierarchy.set_max_number_of_regions(2*num_leaves - 1);
+
+				// score every link once
+				for (uint64 i = 0; i < num_leaves; i++) {
+					RegionType& r = _hierarchy(i);
+					typename RegionType::neighbor_iterator n = r.neighbors_begin();
+					typename RegionType::neighbor_iterator n_end = r.neighbors_end();
+					for (; n != n_end; ++n) {
+						if ((*n)->label() < r.label()) continue;
+						RegionLinkType* link = n.link_data();
+						link->distance = _distance(r, _region(*n));
+						_queue.put(link);
+					}
+				}
+
+				uint64 num_regions = num_leaves;
+				uint64 label = num_leaves;
+				while (!_queue.is_empty()) {
+					RegionLinkType* link = _queue.get_first();
+					if (stop(num_regions, link->distance)) break;
+
+					RegionType& r1 = _region(link->neighbor1);
+					RegionType& r2 = _region(link->neighbor2);
+
+					// the links of the merged regions are deleted by merge_regions
+					_unqueue_links(r1, NULL);
+					_unqueue_links(r2, &r1);
+
+					RegionType& parent = _hierarchy.merge_regions(r1, r2, label++);
+					_distance.merge(parent, r1, r2);
+
+					typename RegionType::neighbor_iterator n = parent.neighbors_begin();
+					typename RegionType::neighbor_iterator n_end = parent.neighbors_end();
+					for (; n != n_end; ++n) {
+						RegionLinkType* l = n.link_data();
+						l->distance = _distance(parent, _region(*n));
+						_queue.put(l);
+					}
+
+					num_regions--;
+				}
+
+				return label - num_leaves;
+			}
+
+			//! Merges until a single region remains (or there are no more links)
+			//! \return number of mergings
+			uint64 build() {
+				return build(StopAtNumberOfRegions(1));
+			}
+
+		protected:
+
+			//! Region of the hierarchy from a neighbor pointer
+			inline static RegionType& _region(RegionBaseType* r) {
+				return *static_cast<RegionType*>(r);
+			}
+
+			//! Removes the links of a region from the queue
+			//! \param[in] r : region
+			//! \param[in] skip : neighbor whose link is not removed (already removed), or NULL
+			void _unqueue_links(RegionType& r, RegionBaseType* skip) {
+				typename RegionType::neighbor_iterator n = r.neighbors_begin();
+				typename RegionType::neighbor_iterator n_end = r.neighbors_end();
+				for (; n != n_end; ++n) {
+					if (*n != skip) _queue.erase(n.link_data());
+				}
+			}
+
+			//! hierarchy being built
+			HierarchyModel& _hierarchy;
+
+			//! link distance
+			DistanceModel& _distance;
+
+			//! links sorted by distance
+			QueueType _queue;
+		};
+
+	}
+}
+
+#endif /* BPT_BUILDER_HPP_ */
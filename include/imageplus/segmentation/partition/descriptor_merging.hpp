@@ -0,0 +1,124 @@
+/*
+ * descriptor_merging.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef DESCRIPTOR_MERGING_HPP_
+#define DESCRIPTOR_MERGING_HPP_
+
+#include <imageplus/core/visual_descriptors.hpp>
+#include <imageplus/core/region_descriptors.hpp>
+#include <imageplus/segmentation/partition/leaf_statistics.hpp>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Link distance of BPTBuilder computed from the descriptors of the regions (coll_vd()).
+		//! The descriptors are computed from the signal only for the leaves. At every merging the descriptors of the new
+		//! region are combined from the ones of its children with DescriptorBase::recursive_calculate, in time independent
+		//! of the size of the region, and the descriptors of the children are freed.
+		//!
+		//! LinkDistanceModel must provide float64 operator()(RegionType& r1, RegionType& r2), reading the descriptors of
+		//! the regions (see WardMeanValueDistance).
+		template<class HierarchyModel, class LinkDistanceModel>
+		class DescriptorDistance {
+		public:
+
+			typedef typename HierarchyModel::RegionType		RegionType;
+
+			//! Constructor
+			//! \param[in] hierarchy : hierarchy initialized with the leaves, and built with this distance
+			//! \param[in] link_distance : distance between the descriptors of two regions
+			DescriptorDistance(HierarchyModel& hierarchy, LinkDistanceModel& link_distance) : _hierarchy(hierarchy), _link_distance(link_distance), _global(NULL) {
+			}
+
+			//! Destructor
+			~DescriptorDistance() {
+				for (uint64 i = 0; i < _prototypes.size(); i++) delete _prototypes[i];
+			}
+
+			//! Computes a descriptor for all the leaves and keeps it updated in the regions created by the mergings.
+			//! Descriptors are combined in the order they are added, so descriptors reading other descriptors of
+			//! the children (peer descriptors) must be added after them.
+			//! \param[in] prototype : descriptor with the parameters to compute (must implement clone and recursive_calculate)
+			//! \param[in] input : data of the leaves (e.g. SignalRegionInput)
+			template<class VDModel, class InputModel>
+			void add_descriptor(const VDModel& prototype, InputModel& input) {
+				uint64 num_leaves = _hierarchy.max_label() + 1;
+				for (uint64 i = 0; i < num_leaves; i++) {
+					calc_descriptor(new VDModel(prototype), input, _hierarchy(i));
+				}
+				_prototypes.push_back(prototype.clone());
+				_global = &input.coll_vd();
+			}
+
+			//! Same as add_descriptor, but setting the descriptors of the leaves from their statistics instead of
+			//! computing them from the signal (see seed_leaf_descriptors)
+			//! \param[in] prototype : descriptor with the parameters to compute (must implement clone, recursive_calculate and assign)
+			//! \param[in] statistics : statistics of the leaves (e.g. LeafStatistics)
+			template<class VDModel, class StatisticsModel>
+			void add_descriptor_from_statistics(const VDModel& prototype, const StatisticsModel& statistics) {
+				seed_leaf_descriptors(prototype, statistics, _hierarchy);
+				_prototypes.push_back(prototype.clone());
+			}
+
+			//! Distance between two neighboring regions
+			inline float64 operator()(RegionType& r1, RegionType& r2) {
+				return _link_distance(r1, r2);
+			}
+
+			//! Combines the descriptors of two merged regions
+			inline void merge(RegionType& parent, RegionType& r1, RegionType& r2) {
+				for (uint64 i = 0; i < _prototypes.size(); i++) {
+					parent.coll_vd().recursive_calculate(_prototypes[i]->clone(), r1.coll_vd(), r2.coll_vd(), _global);
+				}
+			}
+
+		protected:
+
+			//! hierarchy being built
+			HierarchyModel& _hierarchy;
+
+			//! distance between descriptors
+			LinkDistanceModel& _link_distance;
+
+			//! descriptors to combine at every merging
+			std::vector<DescriptorBase*> _prototypes;
+
+			//! global descriptors of the input
+			CollaborativeDescriptors* _global;
+		};
+
+		//! Distance between the VDMeanValue descriptors of two regions (Ward criterion: increase of the squared error)
+		template<uint64 channels>
+		class WardMeanValueDistance {
+		public:
+
+			template<class RegionModel>
+			inline float64 operator()(RegionModel& r1, RegionModel& r2) const {
+				const VDMeanValue<channels>& d1 = r1.coll_vd().get(_key);
+				const VDMeanValue<channels>& d2 = r2.coll_vd().get(_key);
+				const float64 a1 = d1.count();
+				const float64 a2 = d2.count();
+
+				float64 d = 0;
+				for (uint64 c = 0; c < channels; c++) {
+					float64 diff = d1.mean(c) - d2.mean(c);
+					d += diff*diff;
+				}
+				return d * (a1*a2) / (a1 + a2);
+			}
+
+		protected:
+
+			//! descriptor used to look up the descriptors of the regions
+			VDMeanValue<channels> _key;
+		};
+
+	}
+}
+
+#endif /* DESCRIPTOR_MERGING_HPP_ */
@@ -0,0 +1,303 @@
+/*
+ * flatzone_labeling.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef FLATZONE_LABELING_HPP_
+#define FLATZONE_LABELING_HPP_
+
+#include <imageplus/core/iterators/adjacency_scan.hpp>
+#include <boost/static_assert.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Equivalence table between provisional labels (union-find with path halving).
+		//! The root of a set is always its smallest label.
+		class LabelEquivalences {
+		public:
+
+			//! Creates a new provisional label
+			//! \return the new label
+			inline uint64 add() {
+				_parent.push_back(_parent.size());
+				return _parent.size() - 1;
+			}
+
+			//! Returns the root of the set of a label
+			//! \param[in] l : label
+			inline uint64 find(uint64 l) {
+				while (_parent[l] != l) {
+					_parent[l] = _parent[_parent[l]];
+					l = _parent[l];
+				}
+				return l;
+			}
+
+			//! Joins the sets of two labels
+			//! \param[in] root : root of the first set
+			//! \param[in] l : label of the second set
+			//! \return the root of the joined set
+			inline uint64 merge(uint64 root, uint64 l) {
+				l = find(l);
+				if (l < root) {
+					_parent[root] = l;
+					return l;
+				}
+				_parent[l] = root;
+				return root;
+			}
+
+			//! Number of provisional labels
+			inline uint64 size() const {
+				return _parent.size();
+			}
+
+		protected:
+
+			//! parent of every label
+			std::vector<uint64> _parent;
+		};
+
+		//! Two-pass union-find flat zone labelling over blocks of consecutive slices (last dimension) of a signal.
+		//! Every block is labelled on its own, with provisional labels local to the block, so that blocks can be processed
+		//! concurrently (see ParallelFlatZoneLabeler). Labels of adjacent blocks are then joined along their seams.
+		template<ConnectivityType connectivity, class PartitionModel, class SignalModel>
+		class FlatZoneLabeler {
+		public:
+
+			typedef typename PartitionModel::coord_type					coord_type;
+			typedef typename PartitionModel::value_data_type			id_type;
+			typedef typename SignalModel::value_data_type				value_data_type;
+			typedef typename SignalModel::value_const_ret_type			value_const_ret_type;
+			typedef neighbor_offsets<PartitionModel, connectivity>		OffsetsType;
+
+			static const uint64 dimensions = PartitionModel::coord_dimensions;
+			static const uint64 channels = SignalModel::value_dimensions;
+
+			//! Constructor. Only units of the partition with label 0 will be labelled.
+			//! \param[in] partition : partition to label
+			//! \param[in] img : image, with the same domain as partition
+			FlatZoneLabeler(PartitionModel& partition, const SignalModel& img) : _sizes(partition.sizes()), _n(_sizes) {
+				// the units are addressed by their index in dense arrays
+				BOOST_STATIC_ASSERT(SignalModel::packed && PartitionModel::packed);
+
+				// neighbors already visited by the scan (opposites of the forward ones for forward connectivities)
+				for (uint64 k = 0; k < OffsetsType::num_neighbors; k++) {
+					int64 sign = (_n.offsets[k] < 0) ? 1 : (connectivity_traits<connectivity>::symmetric ? 0 : -1);
+					if (sign == 0) continue;
+					_back.push_back(sign*_n.neighborhood.neighbors[k]);
+					_back_offsets.push_back(sign*_n.offsets[k]);
+				}
+
+				_labels = partition.data();
+				_values = img.data();
+
+				_slice_units = _sizes.prod() / _sizes(dimensions-1);
+
+				uint64 N = _sizes.prod();
+				_to_label.resize(N);
+				for (uint64 u = 0; u < N; u++) _to_label[u] = (_labels[u] == 0);
+			}
+
+			//! Number of slices (units in the last dimension)
+			uint64 num_slices() const {
+				return _sizes(dimensions-1);
+			}
+
+			//! First pass over a block: provisional labels and their equivalences.
+			//! Neighbors outside the block are ignored.
+			//! \param[in] first : first slice of the block
+			//! \param[in] end : slice after the last one of the block
+			//! \param[out] eq : equivalences of the provisional labels of the block
+			void scan_block(uint64 first, uint64 end, LabelEquivalences& eq) {
+				coord_type sizes = _sizes;
+				sizes(dimensions-1) = end - first;
+
+				const uint64 length = sizes(0);
+				const uint64 rows = sizes.prod() / length;
+				const uint64 num_back = _back.size();
+
+				bool interior_length = (length >= 2*(uint64)_n.margin(0));
+				const uint64 first_unit = interior_length ? _n.margin(0) : length;
+				const uint64 last_unit = interior_length ? length - _n.margin(0) : length;
+
+				uint64 unit = first*_slice_units;
+				for (uint64 r = 0; r < rows; r++, unit += length) {
+
+					// position of the row inside the block
+					coord_type rel;
+					rel(0) = 0;
+					uint64 rest = r;
+					bool interior_row = interior_length;
+					for (uint64 k = 1; k < dimensions; k++) {
+						rel(k) = rest % sizes(k);
+						rest /= sizes(k);
+						if (rel(k) < _n.margin(k) || rel(k) >= sizes(k) - _n.margin(k)) interior_row = false;
+					}
+					const uint64 first_interior = interior_row ? first_unit : length;
+					const uint64 last_interior = interior_row ? last_unit : length;
+
+					for (uint64 i = 0; i < length; i++, rel(0) = i) {
+						const uint64 u = unit + i;
+						if (!_to_label[u]) continue;
+
+						const bool checked = (i < first_interior || i >= last_interior);
+						const value_const_ret_type v1(_values + u*channels);
+
+						bool labelled = false;
+						uint64 root = 0;
+						for (uint64 k = 0; k < num_back; k++) {
+							if (checked) {
+								coord_type c = rel + _back[k];
+								if ((c.array() < 0).any() || (c.array() >= sizes.array()).any()) continue;
+							}
+							const uint64 v = u + _back_offsets[k];
+							if (!_to_label[v]) continue;
+
+							const value_const_ret_type v2(_values + v*channels);
+							if (!(v1 - v2).isZero()) continue;
+
+							if (labelled) {
+								root = eq.merge(root, _labels[v]);
+							} else {
+								root = eq.find(_labels[v]);
+								labelled = true;
+							}
+						}
+						if (!labelled) root = eq.add();
+						_labels[u] = root;
+					}
+				}
+			}
+
+			//! Second pass over a block: replaces the provisional labels by consecutive labels in order of appearance
+			//! \param[in] first : first slice of the block
+			//! \param[in] end : slice after the last one of the block
+			//! \param[in] eq : equivalences computed by scan_block
+			//! \param[in] first_label : label of the first zone of the block
+			//! \return number of labels of the block
+			uint64 compact_block(uint64 first, uint64 end, LabelEquivalences& eq, uint64 first_label) {
+				std::vector<uint64> block_label(eq.size(), 0);
+				uint64 next = 1;
+				for (uint64 u = first*_slice_units; u < end*_slice_units; u++) {
+					if (!_to_label[u]) continue;
+					uint64 root = eq.find(_labels[u]);
+					if (block_label[root] == 0) block_label[root] = next++;
+					_labels[u] = first_label + block_label[root] - 1;
+				}
+				return next - 1;
+			}
+
+			//! Joins the labels of the first slices of a block with the labels of the previous blocks they are adjacent to.
+			//! Block labels must be compacted from 0; the global label of a unit of block b is base[b] plus its block label.
+			//! \param[in] blocks : first slice of every block (plus the number of slices at the end)
+			//! \param[in] base : first global label of every block
+			//! \param[in] b : block (greater than 0)
+			//! \param[in,out] eq : equivalences of the global labels
+			void merge_seam(const std::vector<uint64>& blocks, const std::vector<uint64>& base, uint64 b, LabelEquivalences& eq) {
+				const uint64 num_back = _back.size();
+				const uint64 first = blocks[b];
+				const uint64 end = std::min(blocks[b+1], first + (uint64)_n.margin(dimensions-1));
+
+				for (uint64 u = first*_slice_units; u < end*_slice_units; u++) {
+					if (!_to_label[u]) continue;
+
+					coord_type pos;
+					uint64 rest = u;
+					for (uint64 k = 0; k < dimensions; k++) {
+						pos(k) = rest % _sizes(k);
+						rest /= _sizes(k);
+					}
+					const value_const_ret_type v1(_values + u*channels);
+
+					for (uint64 k = 0; k < num_back; k++) {
+						coord_type c = pos + _back[k];
+						if ((c.array() < 0).any() || (c.array() >= _sizes.array()).any()) continue;
+						if ((uint64)c(dimensions-1) >= first) continue;
+
+						const uint64 v = u + _back_offsets[k];
+						if (!_to_label[v]) continue;
+
+						const value_const_ret_type v2(_values + v*channels);
+						if (!(v1 - v2).isZero()) continue;
+
+						// block of the neighbor
+						uint64 bv = b - 1;
+						while (blocks[bv] > (uint64)c(dimensions-1)) bv--;
+
+						eq.merge(eq.find(base[b] + _labels[u]), base[bv] + _labels[v]);
+					}
+				}
+			}
+
+			//! Writes the final labels of a block
+			//! \param[in] first : first slice of the block
+			//! \param[in] end : slice after the last one of the block
+			//! \param[in] base : first global label of the block
+			//! \param[in] final_label : final label of every global label
+			void relabel_block(uint64 first, uint64 end, uint64 base, const std::vector<uint64>& final_label) {
+				for (uint64 u = first*_slice_units; u < end*_slice_units; u++) {
+					if (_to_label[u]) _labels[u] = final_label[base + _labels[u]];
+				}
+			}
+
+			//! Labels the whole signal as a single block
+			//! \return number of labels
+			uint64 label() {
+				LabelEquivalences eq;
+				scan_block(0, num_slices(), eq);
+				return compact_block(0, num_slices(), eq, 1);
+			}
+
+		protected:
+
+			//! size for every dimension
+			coord_type _sizes;
+
+			//! neighbor displacements
+			OffsetsType _n;
+
+			//! neighbors visited before the central unit
+			std::vector<coord_type> _back;
+
+			//! displacements of the neighbors visited before the central unit
+			std::vector<int64> _back_offsets;
+
+			//! partition data
+			id_type* _labels;
+
+			//! image data (only read, so shared data is not copied)
+			const value_data_type* _values;
+
+			//! units in a slice
+			uint64 _slice_units;
+
+			//! units to label (label 0 at construction)
+			std::vector<uint8> _to_label;
+		};
+
+		//! Labels the flat zones of an image with a two-pass union-find scan.
+		//! Only units of the partition with label 0 are labelled (other units are left untouched and separate zones),
+		//! and labels start at 1 following the scan order of the first unit of every zone, which gives the same result as
+		//! the flood fill of Partition::set_flatzone_labels_flood_fill for symmetric connectivities.
+		//! Forward connectivities are handled as their symmetric closure.
+		//! The labelling is serial; label_flatzones_parallel (parallel_flatzone_labeling.hpp) gives the same labels
+		//! with several threads.
+		//! \param[in,out] partition : partition to label
+		//! \param[in] img : image, with the same domain as partition
+		//! \return number of labels
+		template<ConnectivityType connectivity, class PartitionModel, class SignalModel>
+		uint64 label_flatzones(PartitionModel& partition, const SignalModel& img) {
+			FlatZoneLabeler<connectivity, PartitionModel, SignalModel> labeler(partition, img);
+			return labeler.label();
+		}
+
+	}
+}
+
+#endif /* FLATZONE_LABELING_HPP_ */
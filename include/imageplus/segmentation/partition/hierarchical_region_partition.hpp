@@ -22,6 +22,7 @@
 
 #include <imageplus/segmentation/io/partition2d_write.hpp>
 #include <imageplus/segmentation/io/partition2d_read.hpp>
+#include <imageplus/segmentation/io/mapped_hierarchy.hpp>
 
 #include <imageplus/segmentation/visualization/false_color.hpp>
 
@@ -43,10 +44,14 @@ namespace imageplus
     //!
     //! \todo Implement a pixel access
     //!
+    //! Regions are created with an allocator chosen by AllocationPolicy (by default the policy of the regions, which also
+    //! allocates their links). With ArenaAllocation all the regions and links are freed in one shot with the partition.
+    //!
     //! \author Jordi Pont Tuset <jpont@gps.tsc.upc.edu>, Guillem Palou
     //!
     //! \date 05-05-2009
-    template<class RegionModel, ConnectivityType adjacency_type = neighborhood_traits<RegionModel::dimensions>::default_forward_connectivity>
+    template<class RegionModel, ConnectivityType adjacency_type = neighborhood_traits<RegionModel::dimensions>::default_forward_connectivity,
+    		 class AllocationPolicy = typename RegionModel::AllocationPolicyType>
     class HierarchicalRegionPartition {
     public:
 
@@ -54,6 +59,8 @@ namespace imageplus
         typedef typename RegionType::identifier_type											identifier_type;  					//!< Type of the region identifiers
         typedef Partition<identifier_type, RegionType::dimensions>								PartitionType;		       			//!< Type of partition pixel-oriented (usually ImagePartition)
         typedef typename RegionType::coord_type 												coord_type;      					//!< Type of coords we are working with
+        typedef typename AllocationPolicy::template allocator<RegionType>::type					RegionAllocatorType;				//!< Allocator of the regions
+        typedef typename RegionType::NeighborContainerType::LinkAllocatorType					LinkAllocatorType;					//!< Allocator of the links between regions
 
     public:
 
@@ -63,6 +70,7 @@ namespace imageplus
         HierarchicalRegionPartition()
         {
         	_num_mergings = 0;
+        	_update_partition = false;
         }
 
         //!
@@ -118,37 +126,29 @@ namespace imageplus
         	//reserve space
         	set_max_number_of_regions(2*_curr_max_label + 1);
 
-        	for (uint64 i = 0; i < current_label; i++) {
-        		RegionType* reg = new RegionType(i);
-        		_regions[i] = reg;
+        	// Leaf coordinates sorted by label: leaf i has the coordinates [_leaf_offsets[i], _leaf_offsets[i+1])
+        	_leaf_offsets.assign(current_label + 1, 0);
+        	for(part_it = _leaves_partition.begin(); part_it != part_end; ++part_it) {
+        		_leaf_offsets[(*part_it)(0) + 1]++;
         	}
+        	for (uint64 i = 0; i < current_label; i++) _leaf_offsets[i+1] += _leaf_offsets[i];
 
-        	part_it = _leaves_partition.begin();
-        	for(; part_it != part_end; ++part_it) {
-        		uint64 label = (*part_it)(0);
-
-        		RegionType& curr_region = *_regions[label];
-        		curr_region.add_coordinate(part_it.pos());
-        		//std::cout << curr_region.size();
+        	_leaf_coords.resize(_leaf_offsets[current_label]);
+        	std::vector<uint64> next(_leaf_offsets.begin(), _leaf_offsets.end() - 1);
+        	for(part_it = _leaves_partition.begin(); part_it != part_end; ++part_it) {
+        		_leaf_coords[next[(*part_it)(0)]++] = part_it.pos();
         	}
 
-        	// Include neighbor information
-        	part_it = _leaves_partition.begin();
-
-        	typedef typename PartitionType::template general_adjacency_iterator<adjacency_type>::type  adj_iterator;
-
-        	for(; part_it != part_end; ++part_it) {
-        		adj_iterator adj		 	= _leaves_partition.template general_adjacency_begin<adjacency_type>(part_it.pos());
-        		adj_iterator adj_end 		= _leaves_partition.template general_adjacency_end<adjacency_type>(part_it.pos());
-        		uint64 label = (*part_it)(0);
-        		for (; adj!=adj_end;++adj) {
-        			uint64 label_adj = (*adj)(0);
-        			if (label == label_adj) continue;
-        			//std::cout << "adding relation " << label << " " << label_adj << std::endl;
-        			_regions[label]->add_neighbor(_regions[label_adj]);
-        		}
+        	for (uint64 i = 0; i < current_label; i++) {
+        		RegionType* reg = new (_region_allocator.allocate()) RegionType(i);
+        		reg->neighbors().set_link_allocator(&_link_allocator);
+        		assign_coordinates(reg->coordinates(), &_leaf_coords[0] + _leaf_offsets[i], &_leaf_coords[0] + _leaf_offsets[i+1]);
+        		_regions[i] = reg;
         	}
 
+        	// Include neighbor information
+        	_neighbor_linker linker(static_cast<const PartitionType&>(_leaves_partition).data(), _regions);
+        	scan_adjacencies<adjacency_type>(_leaves_partition, linker);
         }
 
         inline uint64 correspondence(uint64 init_partition_label) {
@@ -203,14 +203,15 @@ namespace imageplus
         	/*
         	 * We can merge non-neighbor regions.
         	 */
-        	if (father_label != _regions.size()-1) {
-        		ImagePlusError("Index of region out of bounds");
+        	if (father_label >= _regions.size()) {
+        		throw ImagePlusError("Index of region out of bounds");
         	}
 
 
         	_curr_max_label = std::max(_curr_max_label, father_label);
 
-        	RegionType* father_pointer = new RegionType(father_label,region1,region2);
+        	RegionType* father_pointer = new (_region_allocator.allocate()) RegionType(father_label,region1,region2);
+        	father_pointer->neighbors().set_link_allocator(&_link_allocator);
 
         	//std::cout << "merging " << father_label << " " << _curr_max_label << " " << _regions.size() << std::endl;
 
@@ -318,7 +319,7 @@ namespace imageplus
         		// Erase all the regions (only if a map)
         		for (uint64 i = 0; i < to_look.size(); i++) {
         			RegionType* r = _regions[to_look[i]];
-        			delete r;
+        			_region_allocator.deallocate(r);
         			//std::cout << "Pruning " << to_look[i] << std::endl;
         			_regions[to_look[i]] = (RegionType*)NULL;
         		}
@@ -357,8 +358,8 @@ namespace imageplus
         	std::ofstream fout(partition_path.c_str(), std::fstream::binary);
         	std::ofstream fm(mergings_path.c_str(), std::fstream::binary);
 
-        	// Save the leaves partition
-        	typename PartitionType::value_data_type* data = _leaves_partition.data();
+        	// Save the leaves partition (read only, so shared data is not copied)
+        	const typename PartitionType::value_data_type* data = static_cast<const PartitionType&>(_leaves_partition).data();
 
         	coord_type sizes = _leaves_partition.sizes();
         	uint64 l = sizes.prod();
@@ -388,6 +389,13 @@ namespace imageplus
         	fm.close();
         }
 
+        //! Saves the hierarchy in a single file that can be opened without rebuilding it (see MappedHierarchy)
+        //! \param[in] path: path of the file
+        //! \param[in] features: if true the area and bounding box of every region are stored too
+        void save_to_mapped_file(std::string path, bool features = true) {
+        	write_mapped_hierarchy(*this, path, features);
+        }
+
         //! Created to offer compatibility with older PRL files
         void save_prl(std::string image_path, std::string partition_path, std::string merging_sequence_path) {
 
@@ -472,31 +480,17 @@ namespace imageplus
 
         	PRLReader<PartitionType> prl_reader;
 
-        	PartitionType p = prl_reader.read(path);
+        	PartitionType p = prl_reader.read(path, false);
 
         	ImageSignal<float64,3> a = segmentation::to_false_color<ImageSignal<float64,3> >(p);
         	a.write("test.png");
 
         	init(p);
 
-        	std::vector<std::vector<uint64> > mergings = prl_reader.mergings();
-
-        	// Create the leaves of the  tree, read the merging sequence and create the hierarchy
+        	// Create the hierarchy while the merging sequence is parsed
         	_update_partition = false;
-        	_num_mergings = mergings.size();
-
-        	uint64 N = _num_mergings;
-        	for (uint64 i = 0; i < N; i++)
-        	{
-        		//fm >> son1 >> son2 >> father;
-        		//if (fm.eof()) break;
-        		uint64 son1 = mergings[i][0];
-        		uint64 son2 = mergings[i][1];
-        		uint64 father = mergings[i][2];
-        		//std::cout << _correspondences[son1] << " " << _correspondences[son2]<< " " << father << std::endl;
-        		_correspondences[father] = father-1;
-        		merge_regions(_correspondences[son1],_correspondences[son2],father-1);
-        	}
+        	_prl_merger merger(*this);
+        	_num_mergings = prl_reader.read_mergings(merger);
 
         	roots_iterator r = begin();
         	roots_iterator r_end = end();
@@ -508,6 +502,41 @@ namespace imageplus
 
     protected:
 
+        //! Functor merging the regions of a PRL merging sequence (labels of the PRL start at 1)
+        struct _prl_merger {
+
+        	HierarchicalRegionPartition& hierarchy;
+
+        	_prl_merger(HierarchicalRegionPartition& h) : hierarchy(h) {
+        	}
+
+        	inline void operator()(uint64 son1, uint64 son2, uint64 father) {
+        		hierarchy._correspondences[father] = father-1;
+        		hierarchy.merge_regions(hierarchy._correspondences[son1], hierarchy._correspondences[son2], father-1);
+        	}
+        };
+
+        //! Functor linking the leaves found at both sides of an adjacency
+        struct _neighbor_linker {
+
+        	typedef typename PartitionType::value_data_type		label_type;
+
+        	//! labels of the leaves partition
+        	const label_type* labels;
+
+        	//! regions indexed by label
+        	std::vector<RegionModel*>& regions;
+
+        	_neighbor_linker(const label_type* l, std::vector<RegionModel*>& r) : labels(l), regions(r) {
+        	}
+
+        	inline void operator()(uint64 unit, uint64 neighbor) {
+        		label_type label = labels[unit];
+        		label_type label_adj = labels[neighbor];
+        		if (label != label_adj) regions[label]->add_neighbor(regions[label_adj]);
+        	}
+        };
+
         //!
         //! \brief Returns a reference to the region with a given label
         //!
@@ -537,12 +566,20 @@ namespace imageplus
         	}
         }
 
-        //! Clear and deletes all regions
+        //! Clear and deletes all regions (and their links)
+        //! With arenas, the links are not visited and the regions are only destroyed (their members own memory),
+        //! and the blocks of both arenas are freed at once.
         void _clear_regions()
         {
-        	for (uint64 i = 0; i < _regions.size(); i++)
-        		delete _regions[i];
+        	for (uint64 i = 0; i < _regions.size(); i++) {
+        		if (_regions[i] == NULL) continue;
+        		// links allocated one by one are freed by their regions
+        		if (!LinkAllocatorType::bulk_release) _regions[i]->clear_neighbors();
+        		_region_allocator.destroy(_regions[i]);
+        	}
         	_regions.clear();
+        	_region_allocator.release();
+        	_link_allocator.release();
         }
 
         //! Copies all regions
@@ -574,6 +611,18 @@ namespace imageplus
         //! Map of regions
         map_type _regions;
 
+        //! Allocator of the regions
+        RegionAllocatorType _region_allocator;
+
+        //! Allocator of the links between regions
+        LinkAllocatorType _link_allocator;
+
+        //! Coordinates of all the leaves, sorted by label
+        std::vector<coord_type> _leaf_coords;
+
+        //! First coordinate of every leaf in _leaf_coords (plus the total number of coordinates at the end)
+        std::vector<uint64> _leaf_offsets;
+
         //! Copy of the pixel-based partition to implement the pixel access efficiently (todo)
         PartitionType _leaves_partition;
         //! Partition that contains the roots of the three
@@ -0,0 +1,180 @@
+/*
+ * lazy_descriptors.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef LAZY_DESCRIPTORS_HPP_
+#define LAZY_DESCRIPTORS_HPP_
+
+#include <imageplus/core/visual_descriptors.hpp>
+#include <limits>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Descriptor of the regions of a hierarchy computed on demand and memoised in their coll_vd().
+		//!
+		//! The descriptor of a region is computed the first time it is requested, from the memoised descriptors of
+		//! its children when they are available (recursive descriptors) or from the signal. The descriptors are kept
+		//! up to a budget of memoised descriptors: beyond it, the least recently used ones are dropped and computed
+		//! again if they are requested later.
+		//!
+		//! The hierarchy must be modified through prune() and merge_regions() of this class, or invalidate() must
+		//! be called for the regions whose pixels change (their ancestors are invalidated too).
+		template<class VDModel, class InputModel, class HierarchyModel>
+		class LazyDescriptor {
+		public:
+
+			typedef typename HierarchyModel::RegionType		RegionType;
+			typedef typename HierarchyModel::identifier_type	identifier_type;
+
+			//! Constructor
+			//! \param[in] hierarchy : hierarchy to describe
+			//! \param[in] input : data of the regions
+			//! \param[in] prototype : descriptor with the parameters to compute
+			//! \param[in] budget : maximum number of memoised descriptors (the last requested one is always kept)
+			LazyDescriptor(HierarchyModel& hierarchy, InputModel& input, const VDModel& prototype = VDModel(), uint64 budget = std::numeric_limits<uint64>::max())
+				: _hierarchy(hierarchy), _input(input), _prototype(prototype), _budget(budget) {
+			}
+
+			//! Returns the descriptor of a region, computing it if it is not memoised
+			//! \param[in] region : region of the hierarchy
+			//! \return the descriptor, valid until another descriptor is requested or the region is invalidated
+			VDModel& get(RegionType& region) {
+				if (!_is_calculated(region)) _calculate(region);
+				_touch(&region);
+				_enforce_budget(&region);
+				return region.coll_vd().get(_prototype);
+			}
+
+			//! Returns the descriptor of a region, computing it if it is not memoised
+			//! \param[in] label : label of a region of the hierarchy
+			VDModel& get(identifier_type label) {
+				return get(_hierarchy(label));
+			}
+
+			//! Drops the memoised descriptor of a region and all its ancestors, which are computed again when requested
+			//! \param[in] region : region whose pixels have changed
+			void invalidate(RegionType& region) {
+				for (RegionType* r = &region; r != NULL; r = r->parent()) _forget(r);
+			}
+
+			//! Prunes a region of the hierarchy (see HierarchicalRegionPartition::prune). The pixels of the region do
+			//! not change, so its descriptor and the ones of its ancestors are kept, and only the ones of the
+			//! removed descendants are dropped.
+			//! \param[in] region : region to prune
+			void prune(RegionType& region) {
+				std::vector<RegionType*> to_look(region.children().begin(), region.children().end());
+				while (!to_look.empty()) {
+					RegionType* r = to_look.back();
+					to_look.pop_back();
+					_forget(r);
+					to_look.insert(to_look.end(), r->children().begin(), r->children().end());
+				}
+				_hierarchy.prune(region);
+			}
+
+			//! Merges two regions of the hierarchy (see HierarchicalRegionPartition::merge_regions). The descriptor
+			//! of the new region is not computed until it is requested.
+			RegionType& merge_regions(RegionType& region1, RegionType& region2, identifier_type father_label) {
+				return _hierarchy.merge_regions(region1, region2, father_label);
+			}
+
+			//! \return number of memoised descriptors
+			uint64 size() const {
+				return _lru.size();
+			}
+
+			//! Changes the maximum number of memoised descriptors, dropping the least recently used ones if needed
+			void set_budget(uint64 budget) {
+				_budget = budget;
+				_enforce_budget(NULL);
+			}
+
+		protected:
+
+			typedef std::list<RegionType*>								lru_type;
+			typedef std::map<RegionType*, typename lru_type::iterator>	lru_index_type;
+
+			inline bool _is_calculated(RegionType& r) {
+				return r.coll_vd().is_calculated(_prototype.slot());
+			}
+
+			//! Computes the descriptor of a region, combining the ones of its children if they are all memoised
+			//! (recursive descriptors) or else from the signal. Computing the missing descendants first would visit
+			//! all the pixels of the region anyway, plus every region below it.
+			void _calculate(RegionType& region) {
+				bool from_children = _prototype.is_recursive() && region.children().size() != 0;
+				for (uint64 i = 0; from_children && i < region.children().size(); i++) from_children = _is_calculated(*region.child(i));
+
+				if (from_children) {
+					region.coll_vd().recursive_calculate(new VDModel(_prototype), region.child(0)->coll_vd(), region.child(1)->coll_vd(), &_input.coll_vd(), true);
+				} else {
+					region.coll_vd().calculate(new VDModel(_prototype), _input.colors_begin(region), _input.colors_end(region), &_input.coll_vd());
+				}
+				_touch(&region);
+			}
+
+			//! Marks the descriptor of a region as the most recently used
+			void _touch(RegionType* r) {
+				typename lru_index_type::iterator it = _index.find(r);
+				if (it != _index.end()) {
+					_lru.splice(_lru.begin(), _lru, it->second);
+				} else {
+					_lru.push_front(r);
+					_index[r] = _lru.begin();
+				}
+			}
+
+			//! Drops the descriptor of a region
+			void _forget(RegionType* r) {
+				typename lru_index_type::iterator it = _index.find(r);
+				if (it != _index.end()) {
+					_lru.erase(it->second);
+					_index.erase(it);
+				}
+				r->coll_vd().delete_descriptor(_prototype.slot());
+			}
+
+			//! Drops the least recently used descriptors beyond the budget
+			//! \param[in] keep : region whose descriptor is not dropped, or NULL
+			void _enforce_budget(RegionType* keep) {
+				while (_lru.size() > _budget) {
+					RegionType* r = _lru.back();
+					if (r == keep) {
+						if (_lru.size() == 1) break;
+						_lru.splice(_lru.begin(), _lru, --_lru.end());
+						continue;
+					}
+					_forget(r);
+				}
+			}
+
+			//! hierarchy being described
+			HierarchyModel& _hierarchy;
+
+			//! data of the regions
+			InputModel& _input;
+
+			//! descriptor with the parameters to compute
+			VDModel _prototype;
+
+			//! maximum number of memoised descriptors
+			uint64 _budget;
+
+			//! regions with memoised descriptor, most recently used first
+			lru_type _lru;
+
+			//! position of every region in _lru
+			lru_index_type _index;
+		};
+
+	}
+}
+
+#endif /* LAZY_DESCRIPTORS_HPP_ */
@@ -0,0 +1,53 @@
+/*
+ * leaf_scan.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: gpalou
+ */
+
+#ifndef LEAF_SCAN_HPP_
+#define LEAF_SCAN_HPP_
+
+#include <imageplus/core/imageplus_types.hpp>
+#include <boost/static_assert.hpp>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Visits every unit of a partition and of a signal with the same domain in memory order (dimension 0 first),
+		//! reading both as dense arrays, without looking up any value by coordinates. For every unit it calls
+		//! visitor(label, values, pos), with the label of the unit, a pointer to its channels and its coordinates
+		//! (an array of coord_dimensions int64). The signal is only read, so its data is not made unique.
+		//! \param[in] leaves : partition (e.g. HierarchicalRegionPartition::leaves_partition())
+		//! \param[in] signal : signal, with the same domain as leaves
+		//! \param[in] visitor : functor called for every unit
+		template<class PartitionModel, class SignalModel, class VisitorModel>
+		void scan_leaves(PartitionModel& leaves, SignalModel& signal, VisitorModel& visitor) {
+			// the values are read as a dense array
+			BOOST_STATIC_ASSERT(SignalModel::packed && PartitionModel::packed);
+			static const uint64 dimensions = PartitionModel::coord_dimensions;
+			static const uint64 channels = SignalModel::value_dimensions;
+
+			const typename PartitionModel::value_data_type* labels = static_cast<const PartitionModel&>(leaves).data();
+			const typename SignalModel::value_data_type* values = static_cast<const SignalModel&>(signal).data();
+			const typename PartitionModel::coord_type sizes = leaves.sizes();
+			const uint64 N = sizes.prod();
+
+			int64 pos[dimensions];
+			for (uint64 k = 0; k < dimensions; k++) pos[k] = 0;
+
+			for (uint64 u = 0; u < N; u++) {
+				visitor((uint64)labels[u], values + u*channels, pos);
+
+				// next coordinate
+				for (uint64 k = 0; k < dimensions; k++) {
+					if (++pos[k] < sizes(k)) break;
+					pos[k] = 0;
+				}
+			}
+		}
+
+	}
+}
+
+#endif /* LEAF_SCAN_HPP_ */
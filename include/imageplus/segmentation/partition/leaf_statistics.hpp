@@ -0,0 +1,194 @@
+/*
+ * leaf_statistics.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef LEAF_STATISTICS_HPP_
+#define LEAF_STATISTICS_HPP_
+
+#include <imageplus/core/visual_descriptors.hpp>
+#include <imageplus/segmentation/partition/leaf_scan.hpp>
+#include <limits>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Statistics of every label of a partition (count, sum and sum of squares of every channel, bounding box,
+		//! sum of the coordinates and histogram of every channel), stored in arrays indexed by label. The values of a
+		//! label are contiguous in every array, so accumulating a unit touches few cache lines.
+		//!
+		//! They are accumulated in a single scan of the partition and the signal (see scan_leaves), and can be used to seed the descriptors of the leaves of a hierarchy
+		//! (see seed_leaf_descriptors), so calc_descriptor does not iterate the coordinates of the leaves.
+		template<class SignalModel, uint64 histogram_bins = 16>
+		class LeafStatistics {
+		public:
+
+			static const uint64 dimensions = SignalModel::coord_dimensions;
+			static const uint64 channels = SignalModel::value_dimensions;
+			static const uint64 bins = histogram_bins;
+
+			//! Constructor
+			//! \param[in] lower : lowest value of the first bin of the histograms
+			//! \param[in] upper : upper limit of the last bin of the histograms (values out of range go to the first or last bin)
+			LeafStatistics(float64 lower = 0, float64 upper = 256) : _lower(lower), _upper(upper) {
+			}
+
+			//! Accumulates the statistics of every label
+			//! \param[in] leaves : partition labelled from 0 (e.g. HierarchicalRegionPartition::leaves_partition())
+			//! \param[in] signal : signal, with the same domain as leaves
+			//! \param[in] num_labels : number of labels of leaves
+			template<class PartitionModel>
+			void accumulate(PartitionModel& leaves, SignalModel& signal, uint64 num_labels) {
+				_count.assign(num_labels, 0);
+				_sum.assign(num_labels*channels, 0);
+				_sum2.assign(num_labels*channels, 0);
+				_min.assign(num_labels*dimensions, std::numeric_limits<int64>::max());
+				_max.assign(num_labels*dimensions, std::numeric_limits<int64>::min());
+				_m1.assign(num_labels*dimensions, 0);
+				_histogram.assign(num_labels*channels*bins, 0);
+
+				_accumulator accumulator(*this);
+				scan_leaves(leaves, signal, accumulator);
+			}
+
+			//! \return number of labels
+			uint64 size() const {
+				return _count.size();
+			}
+
+			//! \return number of units of a label
+			uint64 count(uint64 label) const {
+				return _count[label];
+			}
+
+			//! \return sum of channel c of a label
+			float64 sum(uint64 label, uint64 c) const {
+				return _sum[label*channels + c];
+			}
+
+			//! \return sum of the squares of channel c of a label
+			float64 sum_of_squares(uint64 label, uint64 c) const {
+				return _sum2[label*channels + c];
+			}
+
+			//! \return variance of channel c of a label
+			float64 variance(uint64 label, uint64 c) const {
+				const float64 mean = sum(label,c) / _count[label];
+				return sum_of_squares(label,c) / _count[label] - mean*mean;
+			}
+
+			//! \return lowest coordinate of a label in dimension k
+			int64 min(uint64 label, uint64 k) const {
+				return _min[label*dimensions + k];
+			}
+
+			//! \return highest coordinate of a label in dimension k (inclusive)
+			int64 max(uint64 label, uint64 k) const {
+				return _max[label*dimensions + k];
+			}
+
+			//! \return coordinate k of the centroid of a label
+			float64 centroid(uint64 label, uint64 k) const {
+				return _m1[label*dimensions + k] / _count[label];
+			}
+
+			//! \return number of units of a label with channel c in bin b
+			uint64 histogram(uint64 label, uint64 c, uint64 b) const {
+				return _histogram[(label*channels + c)*bins + b];
+			}
+
+			//! \return lowest value of the first bin
+			float64 histogram_lower() const {
+				return _lower;
+			}
+
+			//! \return upper limit of the last bin
+			float64 histogram_upper() const {
+				return _upper;
+			}
+
+		protected:
+
+			//! Adds every unit of a scan to the statistics of its label (see scan_leaves)
+			struct _accumulator {
+
+				LeafStatistics& statistics;
+				float64 scale;
+
+				_accumulator(LeafStatistics& s) : statistics(s), scale(bins / (s._upper - s._lower)) {
+				}
+
+				inline void operator()(uint64 l, const typename SignalModel::value_data_type* values, const int64* pos) {
+					LeafStatistics& s = statistics;
+					s._count[l]++;
+
+					for (uint64 c = 0; c < channels; c++) {
+						const float64 v = values[c];
+						s._sum[l*channels + c] += v;
+						s._sum2[l*channels + c] += v*v;
+
+						int64 b = (int64)((v - s._lower) * scale);
+						if (b < 0) b = 0;
+						if (b >= (int64)bins) b = bins - 1;
+						s._histogram[(l*channels + c)*bins + b]++;
+					}
+
+					for (uint64 k = 0; k < dimensions; k++) {
+						const int64 x = pos[k];
+						if (x < s._min[l*dimensions + k]) s._min[l*dimensions + k] = x;
+						if (x > s._max[l*dimensions + k]) s._max[l*dimensions + k] = x;
+						s._m1[l*dimensions + k] += x;
+					}
+				}
+			};
+
+			//! range of the histograms
+			float64 _lower;
+			float64 _upper;
+
+			//! number of units of every label
+			std::vector<uint64> _count;
+
+			//! sum of every channel of every label
+			std::vector<float64> _sum;
+
+			//! sum of the squares of every channel of every label
+			std::vector<float64> _sum2;
+
+			//! lowest coordinate of every label in every dimension
+			std::vector<int64> _min;
+
+			//! highest coordinate of every label in every dimension
+			std::vector<int64> _max;
+
+			//! sum of every coordinate of every label
+			std::vector<float64> _m1;
+
+			//! histogram of every channel of every label
+			std::vector<uint64> _histogram;
+		};
+
+		//! Stores a descriptor in every leaf of a hierarchy, set from the statistics of its label. Leaves with the
+		//! descriptor already calculated are left untouched.
+		//! \param[in] prototype : descriptor with the parameters (must implement assign(statistics, label))
+		//! \param[in] statistics : statistics of the leaves partition of the hierarchy (e.g. LeafStatistics)
+		//! \param[in] hierarchy : hierarchy
+		template<class VDModel, class StatisticsModel, class HierarchyModel>
+		void seed_leaf_descriptors(const VDModel& prototype, const StatisticsModel& statistics, HierarchyModel& hierarchy) {
+			for (uint64 i = 0; i < statistics.size(); i++) {
+				CollaborativeDescriptors& vd = hierarchy(i).coll_vd();
+				if (vd.is_calculated(prototype.slot())) continue;
+
+				VDModel* desc = new VDModel(prototype);
+				desc->assign(statistics, i);
+				vd.create(desc);
+			}
+		}
+
+	}
+}
+
+#endif /* LEAF_STATISTICS_HPP_ */
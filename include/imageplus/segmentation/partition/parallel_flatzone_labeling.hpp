@@ -0,0 +1,106 @@
+/*
+ * parallel_flatzone_labeling.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: gpalou
+ */
+
+#ifndef PARALLEL_FLATZONE_LABELING_HPP_
+#define PARALLEL_FLATZONE_LABELING_HPP_
+
+#include <imageplus/segmentation/partition/flatzone_labeling.hpp>
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Flat zone labelling splitting the signal in blocks of consecutive slices (last dimension, i.e. frames of a
+		//! video) that are labelled by several threads and joined along their seams. The labels are the same as the ones
+		//! of the serial FlatZoneLabeler.
+		template<ConnectivityType connectivity, class PartitionModel, class SignalModel>
+		class ParallelFlatZoneLabeler : public FlatZoneLabeler<connectivity, PartitionModel, SignalModel> {
+		public:
+
+			typedef FlatZoneLabeler<connectivity, PartitionModel, SignalModel>	BaseClassType;
+
+			//! Constructor. Only units of the partition with label 0 will be labelled.
+			//! \param[in] partition : partition to label
+			//! \param[in] img : image, with the same domain as partition
+			ParallelFlatZoneLabeler(PartitionModel& partition, const SignalModel& img) : BaseClassType(partition, img) {
+			}
+
+			//! Labels the signal splitting it in blocks of slices processed by several threads
+			//! \param[in] num_threads : number of threads (0 to use all the available cores)
+			//! \return number of labels
+			uint64 label(uint64 num_threads) {
+				const uint64 num_slices = BaseClassType::num_slices();
+				if (num_threads == 0) num_threads = boost::thread::hardware_concurrency();
+				uint64 num_blocks = std::min(std::max(num_threads, (uint64)1), num_slices);
+				if (num_blocks <= 1) return BaseClassType::label();
+
+				// blocks of consecutive slices
+				std::vector<uint64> blocks(num_blocks + 1);
+				for (uint64 b = 0; b <= num_blocks; b++) blocks[b] = (b * num_slices) / num_blocks;
+
+				// independent labelling of every block
+				std::vector<LabelEquivalences> block_eq(num_blocks);
+				std::vector<uint64> counts(num_blocks);
+				boost::thread_group threads;
+				for (uint64 b = 0; b < num_blocks; b++) {
+					threads.add_thread(new boost::thread(&ParallelFlatZoneLabeler::_label_block, this, blocks[b], blocks[b+1], boost::ref(block_eq[b]), boost::ref(counts[b])));
+				}
+				threads.join_all();
+
+				// global labels: blocks are in scan order, so they keep the order of appearance
+				std::vector<uint64> base(num_blocks + 1, 0);
+				for (uint64 b = 0; b < num_blocks; b++) base[b+1] = base[b] + counts[b];
+
+				LabelEquivalences eq;
+				for (uint64 l = 0; l < base[num_blocks]; l++) eq.add();
+				for (uint64 b = 1; b < num_blocks; b++) BaseClassType::merge_seam(blocks, base, b, eq);
+
+				// the root of every zone is its smallest global label, which is the label of its first unit
+				std::vector<uint64> final_label(base[num_blocks]);
+				uint64 next = 1;
+				for (uint64 l = 0; l < base[num_blocks]; l++) {
+					uint64 root = eq.find(l);
+					final_label[l] = (root == l) ? next++ : final_label[root];
+				}
+
+				boost::thread_group relabel_threads;
+				for (uint64 b = 0; b < num_blocks; b++) {
+					relabel_threads.add_thread(new boost::thread(&BaseClassType::relabel_block, this, blocks[b], blocks[b+1], base[b], boost::cref(final_label)));
+				}
+				relabel_threads.join_all();
+
+				return next - 1;
+			}
+
+		protected:
+
+			//! Labels a block on its own
+			void _label_block(uint64 first, uint64 end, LabelEquivalences& eq, uint64& count) {
+				BaseClassType::scan_block(first, end, eq);
+				count = BaseClassType::compact_block(first, end, eq, 0);
+			}
+		};
+
+		//! Labels the flat zones of an image as label_flatzones, splitting the signal in blocks of slices (last
+		//! dimension, i.e. frames of a video) that are labelled concurrently and joined along their seams. The labels
+		//! are the same as with label_flatzones. Requires linking with boost_thread.
+		//! \param[in,out] partition : partition to label
+		//! \param[in] img : image, with the same domain as partition
+		//! \param[in] num_threads : number of threads (0 to use all the available cores)
+		//! \return number of labels
+		template<ConnectivityType connectivity, class PartitionModel, class SignalModel>
+		uint64 label_flatzones_parallel(PartitionModel& partition, const SignalModel& img, uint64 num_threads = 0) {
+			ParallelFlatZoneLabeler<connectivity, PartitionModel, SignalModel> labeler(partition, img);
+			return labeler.label(num_threads);
+		}
+
+	}
+}
+
+#endif /* PARALLEL_FLATZONE_LABELING_HPP_ */
@@ -9,6 +9,7 @@
 #define IMAGE_PARTITION_SIGNAL_HPP_
 
 #include <imageplus/core/signal.hpp>
+#include <imageplus/segmentation/partition/flatzone_labeling.hpp>
 #include <deque>
 #include <fstream>
 
@@ -74,7 +75,7 @@ namespace imageplus {
 			 * Returns the size in the first dimension
 			 * \return size of x
 			 */
-			uint64 size_x() {
+			uint64 size_x() const {
 				return BaseClassType::_sizes(0);
 			}
 
@@ -82,7 +83,7 @@ namespace imageplus {
 			 * Returns the size in the second dimension
 			 * \return size of y
 			 */
-			uint64 size_y() {
+			uint64 size_y() const {
 				return BaseClassType::_sizes(1);
 			}
 
@@ -90,7 +91,7 @@ namespace imageplus {
 			 * Returns the size in the third dimension
 			 * \return size of z
 			 */
-			uint64 size_z() {
+			uint64 size_z() const {
 				return BaseClassType::_sizes(2);
 			}
 
@@ -98,37 +99,62 @@ namespace imageplus {
 			 * Sets a unique label for each unit
 			 */
 			void set_unique_labels() {
-				typename BaseClassType::iterator it = (*this).begin();
-				typename BaseClassType::iterator end = (*this).end();
+				typename BaseClassType::span_iterator s = this->span_begin();
+				typename BaseClassType::span_iterator s_end = this->span_end();
 				_max_label = 1;
-				for (; it != end; ++it) {
-					(*it)(0) = _max_label++;
+				for (; s != s_end; ++s) {
+					id_type* label = s->data;
+					for (uint64 i = 0; i < s->length; i++) {
+						*label++ = _max_label++;
+					}
 				}
 				_max_label--;
 			}
 
 			/*!
-			 * Finds equal zones and labels them (aka. label_flatzone)
+			 * Finds equal zones and labels them (aka. label_flatzone).
+			 * Symmetric connectivities use the union-find labelling of label_flatzones, forward ones the flood fill.
+			 * Both are serial (see label_flatzones_parallel to label blocks of slices with several threads).
+			 * \param[in] img : image to label
 			 */
 			template<ConnectivityType adjacency_type, class channel_type, uint64 channels>
 			void set_flatzone_labels(Signal<int64, channel_type, dimensions, channels>& img) {
+				if (connectivity_traits<adjacency_type>::symmetric) {
+					_max_label = label_flatzones<adjacency_type>(*this, img);
+				} else {
+					set_flatzone_labels_flood_fill<adjacency_type>(img);
+				}
+			}
+
+			/*!
+			 * Finds equal zones and labels them with a flood fill from every unlabelled unit
+			 */
+			template<ConnectivityType adjacency_type, class channel_type, uint64 channels>
+			void set_flatzone_labels_flood_fill(Signal<int64, channel_type, dimensions, channels>& img) {
 
 				typedef	Signal<int64, channel_type, dimensions, channels> 				SignalType;
 				typedef typename SignalType::coord_type									coord_type;
 				typedef typename SignalType::value_type									value_type;
 
-				typename BaseClassType::iterator it = (*this).begin();
-				typename BaseClassType::iterator end = (*this).end();
+				// the image is only read
+				const SignalType& cimg = img;
+
+				typename BaseClassType::span_iterator s = this->span_begin();
+				typename BaseClassType::span_iterator s_end = this->span_end();
 
 				typedef typename BaseClassType::template general_adjacency_iterator<adjacency_type>::type  neighbor_iterator;
 
 				uint64 curr_value = 1;
-				for (;it != end; ++it) {
-					//std::cout << " * " << it.pos().transpose() << " " << std::endl;
-					if((*it).isZero())
-					{
+				for (; s != s_end; ++s) {
+					id_type* label = s->data;
+					for (uint64 i = 0; i < s->length; i++, label++) {
+						if (*label != 0) continue;
+
+						coord_type seed = s->pos;
+						seed(0) += i;
+
 						std::deque<coord_type> to_scan;
-						to_scan.push_back(it.pos());
+						to_scan.push_back(seed);
 
 						while(!to_scan.empty())
 						{
@@ -139,11 +165,10 @@ namespace imageplus {
 							neighbor_iterator neigh_it_end 		= BaseClassType::template general_adjacency_end<adjacency_type>(t);
 							for( ; neigh_it!=neigh_it_end; ++neigh_it)
 							{
-								//std::cout << t.transpose() << " " << neigh_it().transpose() << std::endl;
 								if((*neigh_it).isZero())
 								{
-									const value_type& v1 =  img(t);
-									const value_type& v2 =  img(neigh_it.pos());
+									const value_type& v1 =  cimg(t);
+									const value_type& v2 =  cimg(neigh_it.pos());
 									if((v1 - v2).isZero())
 									{
 										(*this)(neigh_it.pos())(0)=curr_value;
@@ -156,7 +181,6 @@ namespace imageplus {
 						}
 						curr_value++;
 					}
-					//exit(0);
 				}
 				_max_label = curr_value-1;
 			}
@@ -164,8 +188,8 @@ namespace imageplus {
 			void write_partition(std::string partition_path) {
 				std::ofstream fout(partition_path.c_str(), std::fstream::binary);
 
-				// Save the leaves partition
-				typename BaseClassType::value_data_type* data = this->data();
+				// Save the leaves partition (read only, so shared data is not copied)
+				const typename BaseClassType::value_data_type* data = static_cast<const BaseClassType*>(this)->data();
 
 				uint64 l = BaseClassType::_sizes.prod();
 
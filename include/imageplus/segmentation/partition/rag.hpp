@@ -26,14 +26,14 @@ namespace imageplus {
 		//! This function must be implemented
 		void init(PartitionType& partition)
 		{
-			// Scan all regions
-			typename PartitionType::iterator part_end = partition.end();
-			typename PartitionType::iterator part_it = partition.begin();
+			// Scan all regions (the partition is only read, so shared data is not copied)
+			const PartitionType& leaves = partition;
+			typename PartitionType::const_span_iterator s = leaves.span_begin();
+			typename PartitionType::const_span_iterator s_end = leaves.span_end();
 
 			std::set<uint64> labels;
-			for(; part_it != part_end; ++part_it) {
-				uint64 label = (*part_it)(0);
-				labels.insert(label);
+			for(; s != s_end; ++s) {
+				for (uint64 i = 0; i < s->length; i++) labels.insert(s->data[i]);
 			}
 
 			_rag = Graph();
@@ -46,32 +46,38 @@ namespace imageplus {
 			}
 
 			// Include neighbor information
+			_edge_adder adder(leaves.data(), _rag, nodes);
+			scan_adjacencies<adjacency_type>(partition, adder);
+		}
+
+		Graph& rag() {
+			return _rag;
+		}
 
-			part_it = partition.begin();
-			typedef typename PartitionType::template general_adjacency_iterator<adjacency_type>::type  adj_iterator;
+	protected:
 
-			for(; part_it != part_end; ++part_it) {
-				adj_iterator adj		 	= partition.template general_adjacency_begin<adjacency_type>(part_it.pos());
-				adj_iterator adj_end 		= partition.template general_adjacency_end<adjacency_type>(part_it.pos());
-				uint64 label = (*part_it)(0);
+		//! Functor adding an edge between the nodes found at both sides of an adjacency
+		struct _edge_adder {
 
-				for (; adj!=adj_end;++adj) {
-					uint64 label_adj = (*adj)(0);
+			typedef typename PartitionType::value_data_type		label_type;
 
-					if (label == label_adj) continue;
-					if (_rag.edge_exists(nodes[label], nodes[label_adj])) continue;
+			const label_type* labels;
+			Graph& graph;
+			std::map<uint64,Graph::Node>& nodes;
 
-					_rag.add_edge(nodes[label], nodes[label_adj]);
-				}
+			_edge_adder(const label_type* l, Graph& g, std::map<uint64,Graph::Node>& n) : labels(l), graph(g), nodes(n) {
 			}
 
-		}
+			inline void operator()(uint64 unit, uint64 neighbor) {
+				uint64 label = labels[unit];
+				uint64 label_adj = labels[neighbor];
 
-		Graph& rag() {
-			return _rag;
-		}
+				if (label == label_adj) return;
+				if (graph.edge_exists(nodes[label], nodes[label_adj])) return;
 
-	protected:
+				graph.add_edge(nodes[label], nodes[label_adj]);
+			}
+		};
 
 		Graph _rag;
 
@@ -0,0 +1,212 @@
+/*
+ * region_feature_table.hpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#ifndef REGION_FEATURE_TABLE_HPP_
+#define REGION_FEATURE_TABLE_HPP_
+
+#include <imageplus/core/imageplus_types.hpp>
+#include <imageplus/segmentation/partition/leaf_scan.hpp>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace imageplus {
+	namespace segmentation {
+
+		//! Features of all the regions of a hierarchy stored by columns: one array indexed by label for every field
+		//! (area, sum of every channel, bounding box and first and second order moments of the coordinates).
+		//!
+		//! The leaves are accumulated in one raster scan of the leaves partition and the signal (see scan_leaves), and the rest of the
+		//! regions are combined from their children in a post-order traversal of the hierarchy. No memory is
+		//! allocated per region, and the columns can be exported or processed directly (e.g. mean = sum / area).
+		//! Labels without region keep zero area.
+		template<class HierarchyModel, class SignalModel>
+		class RegionFeatureTable {
+		public:
+
+			typedef typename HierarchyModel::RegionType		RegionType;
+
+			static const uint64 dimensions = SignalModel::coord_dimensions;
+			static const uint64 channels = SignalModel::value_dimensions;
+
+			//! Number of second order moments (x_k*x_j with j >= k)
+			static const uint64 num_moments2 = dimensions*(dimensions + 1)/2;
+
+			//! Default constructor, the table is empty until compute() is called
+			RegionFeatureTable() {
+			}
+
+			//! Constructor computing the features of a hierarchy
+			//! \param[in] hierarchy : hierarchy, whose leaves are labelled from 0 in leaves_partition()
+			//! \param[in] signal : signal, with the same domain as the leaves partition
+			RegionFeatureTable(HierarchyModel& hierarchy, SignalModel& signal) {
+				compute(hierarchy, signal);
+			}
+
+			//! Computes the features of all the regions of a hierarchy
+			//! \param[in] hierarchy : hierarchy, whose leaves are labelled from 0 in leaves_partition()
+			//! \param[in] signal : signal, with the same domain as the leaves partition
+			void compute(HierarchyModel& hierarchy, SignalModel& signal) {
+				_resize(hierarchy.max_label() + 1);
+				_accumulate_leaves(hierarchy.leaves_partition(), signal);
+				_combine(hierarchy);
+			}
+
+			//! \return number of rows (max label + 1)
+			uint64 size() const {
+				return _area.size();
+			}
+
+			//! \return column of areas
+			const std::vector<float64>& area() const {
+				return _area;
+			}
+
+			//! \return column of the sums of channel c
+			const std::vector<float64>& sum(uint64 c) const {
+				return _sum[c];
+			}
+
+			//! \return column of the lowest coordinates in dimension k
+			const std::vector<int64>& min(uint64 k) const {
+				return _min[k];
+			}
+
+			//! \return column of the highest coordinates in dimension k (inclusive)
+			const std::vector<int64>& max(uint64 k) const {
+				return _max[k];
+			}
+
+			//! \return column of the sums of coordinate k
+			const std::vector<float64>& moment(uint64 k) const {
+				return _m1[k];
+			}
+
+			//! \return column of the sums of the products of coordinates k and j
+			const std::vector<float64>& moment(uint64 k, uint64 j) const {
+				return (k <= j) ? _m2[_moment2_index(k,j)] : _m2[_moment2_index(j,k)];
+			}
+
+			//! \return mean of channel c of a region
+			float64 mean(uint64 label, uint64 c) const {
+				return _sum[c][label] / _area[label];
+			}
+
+			//! \return coordinate k of the centroid of a region
+			float64 centroid(uint64 label, uint64 k) const {
+				return _m1[k][label] / _area[label];
+			}
+
+		protected:
+
+			//! Column of the second order moment x_k*x_j, with k <= j
+			static inline uint64 _moment2_index(uint64 k, uint64 j) {
+				return k*dimensions - k*(k+1)/2 + j;
+			}
+
+			//! Resizes and clears all the columns
+			void _resize(uint64 rows) {
+				_area.assign(rows, 0);
+				for (uint64 c = 0; c < channels; c++) _sum[c].assign(rows, 0);
+				for (uint64 k = 0; k < dimensions; k++) {
+					_min[k].assign(rows, std::numeric_limits<int64>::max());
+					_max[k].assign(rows, std::numeric_limits<int64>::min());
+					_m1[k].assign(rows, 0);
+				}
+				for (uint64 m = 0; m < num_moments2; m++) _m2[m].assign(rows, 0);
+			}
+
+			//! Accumulates the features of the leaves scanning the leaves partition in memory order (see scan_leaves)
+			template<class PartitionModel>
+			void _accumulate_leaves(PartitionModel& leaves, SignalModel& signal) {
+				_accumulator accumulator(*this);
+				scan_leaves(leaves, signal, accumulator);
+			}
+
+			//! Adds every unit of a scan to the features of its leaf
+			struct _accumulator {
+
+				RegionFeatureTable& table;
+
+				_accumulator(RegionFeatureTable& t) : table(t) {
+				}
+
+				inline void operator()(uint64 l, const typename SignalModel::value_data_type* values, const int64* pos) {
+					RegionFeatureTable& t = table;
+					t._area[l]++;
+					for (uint64 c = 0; c < channels; c++) t._sum[c][l] += values[c];
+
+					for (uint64 k = 0, m = 0; k < dimensions; k++) {
+						const int64 x = pos[k];
+						if (x < t._min[k][l]) t._min[k][l] = x;
+						if (x > t._max[k][l]) t._max[k][l] = x;
+						t._m1[k][l] += x;
+						for (uint64 j = k; j < dimensions; j++, m++) t._m2[m][l] += float64(x)*pos[j];
+					}
+				}
+			};
+
+			//! Combines the features of the children of every region, visiting the trees from their roots in post-order
+			void _combine(HierarchyModel& hierarchy) {
+				typedef typename HierarchyModel::roots_iterator roots_iterator;
+				std::vector<std::pair<RegionType*, bool> > stack;
+
+				roots_iterator it = hierarchy.begin();
+				roots_iterator it_end = hierarchy.end();
+				for (; it != it_end; ++it) {
+					stack.push_back(std::make_pair(&(*it), false));
+					while (!stack.empty()) {
+						RegionType* r = stack.back().first;
+						if (r->children().empty()) {
+							stack.pop_back();
+						} else if (!stack.back().second) {
+							// children first
+							stack.back().second = true;
+							for (uint64 i = 0; i < r->children().size(); i++) stack.push_back(std::make_pair(r->child(i), false));
+						} else {
+							stack.pop_back();
+							for (uint64 i = 0; i < r->children().size(); i++) _add(r->label(), r->child(i)->label());
+						}
+					}
+				}
+			}
+
+			//! Adds the features of a child to its parent
+			inline void _add(uint64 parent, uint64 child) {
+				_area[parent] += _area[child];
+				for (uint64 c = 0; c < channels; c++) _sum[c][parent] += _sum[c][child];
+				for (uint64 k = 0; k < dimensions; k++) {
+					if (_min[k][child] < _min[k][parent]) _min[k][parent] = _min[k][child];
+					if (_max[k][child] > _max[k][parent]) _max[k][parent] = _max[k][child];
+					_m1[k][parent] += _m1[k][child];
+				}
+				for (uint64 m = 0; m < num_moments2; m++) _m2[m][parent] += _m2[m][child];
+			}
+
+			//! area of every region
+			std::vector<float64> _area;
+
+			//! sum of every channel of every region
+			std::vector<float64> _sum[channels];
+
+			//! lowest coordinate of every region in every dimension
+			std::vector<int64> _min[dimensions];
+
+			//! highest coordinate of every region in every dimension
+			std::vector<int64> _max[dimensions];
+
+			//! sum of every coordinate of every region
+			std::vector<float64> _m1[dimensions];
+
+			//! sum of the products of every pair of coordinates of every region
+			std::vector<float64> _m2[num_moments2];
+		};
+
+	}
+}
+
+#endif /* REGION_FEATURE_TABLE_HPP_ */
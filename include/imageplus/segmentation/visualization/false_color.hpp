@@ -8,19 +8,30 @@
 #ifndef FALSE_COLOR_HPP_
 #define FALSE_COLOR_HPP_
 
+#include <boost/static_assert.hpp>
+
 namespace imageplus {
 	namespace segmentation {
 
 			template<class Signal, class PartitionModel>
 			Signal to_false_color(PartitionModel& part) {
+				// the output is written as a dense array
+				BOOST_STATIC_ASSERT(Signal::packed);
+
 				std::map<uint64, uint64> 		color_map;
 
 				uint32 current_label = 0;
 
-				for (typename PartitionModel::iterator v = part.begin(); v != part.end(); ++v) {
-					uint64 label = (*v)(0);
-					if (color_map.find(label) == color_map.end()) {
-						color_map[label] = current_label++;
+				// the partition is only read, so shared data is not copied
+				const PartitionModel& labels = part;
+				typename PartitionModel::const_span_iterator s = labels.span_begin();
+				typename PartitionModel::const_span_iterator s_end = labels.span_end();
+				for (; s != s_end; ++s) {
+					for (uint64 i = 0; i < s->length; i++) {
+						uint64 label = s->data[i];
+						if (color_map.find(label) == color_map.end()) {
+							color_map[label] = current_label++;
+						}
 					}
 				}
 
@@ -42,16 +53,15 @@ namespace imageplus {
 				//std::cout << "There are " << current_label << " regions " << std::endl;
 				Signal 				segmented(part.sizes());
 
-				for (typename PartitionModel::iterator v = part.begin(); v != part.end(); ++v) {
-					typename Signal::coord_type pos = v.pos();
-					uint64 label = (*v)(0);
-					if (color_map.find(label) == color_map.end()) {
-						color_map[label] = current_label++;
-					}
-
-					std::vector<uint8>& color = colors[color_map[label]];
+				typename Signal::value_data_type* out = segmented.data();
+				for (s = labels.span_begin(); s != s_end; ++s) {
+					for (uint64 i = 0; i < s->length; i++, out += Signal::value_dimensions) {
+						std::vector<uint8>& color = colors[color_map[s->data[i]]];
 
-					segmented(pos) = typename Signal::value_type(color[0],color[1],color[2]);
+						out[0] = color[0];
+						out[1] = color[1];
+						out[2] = color[2];
+					}
 				}
 
 				return segmented;
@@ -59,18 +69,25 @@ namespace imageplus {
 
 			template<class PartitionModel, class Signal>
 			PartitionModel to_partition(Signal& segmented) {
+				// the input is read as a dense array
+				BOOST_STATIC_ASSERT(Signal::packed);
+
 				std::map<uint64, uint64> 		id_map;
 				PartitionModel part(segmented.sizes());
 
 				uint64 current_label = 0;
-				for (typename PartitionModel::iterator v = part.begin(); v != part.end(); ++v) {
-					typename PartitionModel::coord_type pos = v.pos();
-					uint64 c_id = segmented(pos)(0)*255*255 + segmented(pos)(1)*255 + segmented(pos)(2);
-					if (id_map.find(c_id) == id_map.end()) {
-						id_map[c_id] = current_label++;
-						(*v)(0) = current_label-1;
-					} else {
-						(*v)(0) = id_map[c_id];
+				const typename Signal::value_data_type* in = static_cast<const Signal&>(segmented).data();
+				typename PartitionModel::span_iterator s = part.span_begin();
+				typename PartitionModel::span_iterator s_end = part.span_end();
+				for (; s != s_end; ++s) {
+					for (uint64 i = 0; i < s->length; i++, in += Signal::value_dimensions) {
+						uint64 c_id = in[0]*255*255 + in[1]*255 + in[2];
+						if (id_map.find(c_id) == id_map.end()) {
+							id_map[c_id] = current_label++;
+							s->data[i] = current_label-1;
+						} else {
+							s->data[i] = id_map[c_id];
+						}
 					}
 				}
 				part.set_max_label(current_label-1);
@@ -0,0 +1,68 @@
+/*
+ * bpt_builder_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/bpt_builder.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,float64,2,3>												ImageType;
+typedef segmentation::Partition<uint64,2>										PartitionType;
+typedef PartitionType::coord_type												coord_type;
+typedef HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, FlatNeighborStorage<> >	RegionType;
+typedef segmentation::HierarchicalRegionPartition<RegionType>					HierarchyType;
+typedef segmentation::MeanValueDistance<RegionType, ImageType>					DistanceType;
+
+//! Time to build a whole BPT from a grid of leaves with the mean colour (Ward) distance
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 14;
+
+	// square leaves of random colour
+	uint64 cols = (sx + block - 1) / block;
+	uint64 rows = (sy + block - 1) / block;
+	std::vector<float64> colours(3*cols*rows);
+	srand(0);
+	for (uint64 i = 0; i < colours.size(); i++) colours[i] = rand() % 256;
+
+	PartitionType leaves(sx,sy);
+	ImageType img(ImageType::coord_type(sx,sy));
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			uint64 l = (y/block)*cols + x/block;
+			leaves(x,y)(0) = l;
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = colours[3*l + c];
+		}
+	}
+
+	HierarchyType h;
+
+	clock_t t = clock();
+	h.init(leaves);
+	float64 t_init = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	DistanceType distance(h.leaves_partition(), img, h.max_label() + 1);
+	segmentation::BPTBuilder<HierarchyType, DistanceType> builder(h, distance);
+	uint64 merges = builder.build();
+	float64 t_build = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	std::cout << "size " << sx << "x" << sy << ", " << cols*rows << " leaves" << std::endl;
+	std::cout << "init  : " << t_init << " s" << std::endl;
+	std::cout << "build : " << t_build << " s (" << merges << " merges)" << std::endl;
+	return 0;
+}
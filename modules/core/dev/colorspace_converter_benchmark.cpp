@@ -0,0 +1,109 @@
+/*
+ * colorspace_converter_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/colorspace_converter.hpp>
+
+#include <ctime>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef ImageSignal<float64,3>		ImageType;
+
+//! Converter exposing the per-value conversion, converting pixel by pixel through the signal iterator
+class PerValueConverter : public ColorSpaceConverter<ImageType> {
+public:
+
+	void convert_per_value(ImageType& s, ColorSpaceType output_color_space) {
+		for (ImageType::iterator p = s.begin(); p != s.end(); ++p) {
+			ImageType::value_type v = convert(*p, s.color_space(), output_color_space);
+			*p = v;
+		}
+		s.set_color_space(output_color_space);
+	}
+};
+
+//! Converts an image to a color space in both ways, and reports the throughput and the largest difference
+void run(ImageType& input, ColorSpaceType output, const char* name) {
+	PerValueConverter converter;
+	float64 mpix = float64(input.size_x()*input.size_y()) / 1e6;
+
+	ImageType a(input.sizes()), b(input.sizes());
+	std::copy(input.data(), input.data() + input.sizes().prod()*3, a.data());
+	std::copy(input.data(), input.data() + input.sizes().prod()*3, b.data());
+	a.set_color_space(input.color_space());
+	b.set_color_space(input.color_space());
+
+	clock_t t = clock();
+	converter.convert_per_value(a, output);
+	float64 t_value = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	converter.convert(b, output);
+	float64 t_bulk = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	float64 diff = 0;
+	const uint64 values = input.sizes().prod()*3;
+	for (uint64 i = 0; i < values; i++) diff = std::max(diff, std::fabs(a.data()[i] - b.data()[i]));
+
+	std::cout << name << " : per value " << mpix/t_value << " MPix/s, bulk " << mpix/t_bulk << " MPix/s, max difference " << diff << std::endl;
+}
+
+//! Time to read an image in LAB, converting after reading or while reading
+void run_read(const std::string& path) {
+	ColorSpaceConverter<ImageType> converter;
+
+	clock_t t = clock();
+	ImageType a;
+	a.read(path);
+	converter.convert(a, ColorSpaceLAB);
+	float64 t_after = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	ImageType b;
+	b.read(path, ColorSpaceLAB);
+	float64 t_fused = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	float64 diff = 0;
+	const uint64 values = a.sizes().prod()*3;
+	for (uint64 i = 0; i < values; i++) diff = std::max(diff, std::fabs(a.data()[i] - b.data()[i]));
+
+	std::cout << "read " << path << " in LAB : read + convert " << t_after << " s, fused " << t_fused << " s, max difference " << diff << std::endl;
+}
+
+//! Throughput of the color space conversions of an image with 8-bit values.
+//! With a third argument, also the time to read that image in LAB.
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+
+	ImageType rgb(sx,sy);
+	srand(0);
+	for (uint64 i = 0; i < sx*sy*3; i++) rgb.data()[i] = rand() % 256;
+
+	PerValueConverter converter;
+	ImageType yuv(rgb), lab(rgb);
+	converter.convert_per_value(yuv, ColorSpaceYUV);
+	converter.convert_per_value(lab, ColorSpaceLAB);
+
+	std::cout << "size " << sx << "x" << sy << std::endl;
+	run(rgb, ColorSpaceYUV, "RGB -> YUV");
+	run(rgb, ColorSpaceLAB, "RGB -> LAB");
+	run(yuv, ColorSpaceRGB, "YUV -> RGB");
+	run(yuv, ColorSpaceLAB, "YUV -> LAB");
+	run(lab, ColorSpaceRGB, "LAB -> RGB");
+	run(lab, ColorSpaceYUV, "LAB -> YUV");
+
+	if (argc > 3) run_read(argv[3]);
+	return 0;
+}
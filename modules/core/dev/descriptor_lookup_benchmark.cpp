@@ -0,0 +1,105 @@
+/*
+ * descriptor_lookup_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/core/region_descriptors.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/bpt_builder.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,float64,2,3>												ImageType;
+typedef segmentation::Partition<uint64,2>										PartitionType;
+typedef PartitionType::coord_type												coord_type;
+typedef HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, FlatNeighborStorage<> >	RegionType;
+typedef segmentation::HierarchicalRegionPartition<RegionType>					HierarchyType;
+typedef segmentation::MeanValueDistance<RegionType, ImageType>					DistanceType;
+typedef SignalRegionInput<ImageType>											InputType;
+
+//! Computes a descriptor for a region of the hierarchy, from the pixels for the leaves and from the children for
+//! the rest, keeping the descriptors of the children
+template<class VDModel>
+void describe(RegionType& r, InputType& input) {
+	if (r.children().empty()) {
+		r.coll_vd().calculate(new VDModel(), input.colors_begin(r), input.colors_end(r), &input.coll_vd());
+	} else {
+		VDModel* desc = new VDModel();
+		desc->recursive_calculate(r.child(0)->coll_vd(), r.child(1)->coll_vd(), &r.coll_vd());
+		r.coll_vd().create(desc);
+	}
+}
+
+//! Time to compute area, mean colour, bounding box and histogram for all the regions of a whole BPT, and to look
+//! them up afterwards
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 10;
+	uint64 queries = (argc > 4) ? atoi(argv[4]) : 20;
+
+	// square leaves of random colour
+	uint64 cols = (sx + block - 1) / block;
+	uint64 rows = (sy + block - 1) / block;
+	std::vector<float64> colours(3*cols*rows);
+	srand(0);
+	for (uint64 i = 0; i < colours.size(); i++) colours[i] = rand() % 256;
+
+	PartitionType leaves(sx,sy);
+	ImageType img(ImageType::coord_type(sx,sy));
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			uint64 l = (y/block)*cols + x/block;
+			leaves(x,y)(0) = l;
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = colours[3*l + c];
+		}
+	}
+
+	HierarchyType h;
+	h.init(leaves);
+	DistanceType distance(h.leaves_partition(), img, h.max_label() + 1);
+	segmentation::BPTBuilder<HierarchyType, DistanceType> builder(h, distance);
+	builder.build();
+	uint64 num_regions = h.max_label() + 1;
+
+	InputType input(img);
+
+	// regions are labelled bottom-up, so children are described before their parents
+	clock_t t = clock();
+	for (uint64 l = 0; l < num_regions; l++) {
+		describe<VDArea>(h(l), input);
+		describe<VDMeanValue<3> >(h(l), input);
+		describe<VDBoundingBox<2> >(h(l), input);
+		describe<VDHistogram<3,16> >(h(l), input);
+	}
+	float64 t_describe = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	VDArea area;
+	VDMeanValue<3> mean;
+	float64 checksum = 0;
+	for (uint64 k = 0; k < queries; k++) {
+		for (uint64 l = 0; l < num_regions; l++) {
+			CollaborativeDescriptors& vd = h(l).coll_vd();
+			if (vd.is_calculated(mean.id())) checksum += vd.get(mean).mean(0);
+			checksum += vd.get(area).area();
+		}
+	}
+	float64 t_query = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	std::cout << "size " << sx << "x" << sy << ", " << num_regions << " regions" << std::endl;
+	std::cout << "describe : " << t_describe << " s" << std::endl;
+	std::cout << "query    : " << t_query << " s (" << 3*queries*num_regions << " lookups, checksum " << checksum << ")" << std::endl;
+	return 0;
+}
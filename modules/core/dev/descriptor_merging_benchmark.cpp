@@ -0,0 +1,128 @@
+/*
+ * descriptor_merging_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/core/region_descriptors.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/bpt_builder.hpp>
+#include <imageplus/segmentation/partition/descriptor_merging.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,float64,2,3>												ImageType;
+typedef segmentation::Partition<uint64,2>										PartitionType;
+typedef PartitionType::coord_type												coord_type;
+typedef HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, FlatNeighborStorage<> >	RegionType;
+typedef segmentation::HierarchicalRegionPartition<RegionType>					HierarchyType;
+typedef SignalRegionInput<ImageType>											InputType;
+typedef segmentation::WardMeanValueDistance<3>									LinkDistanceType;
+
+//! Same distance as DescriptorDistance, but computing the descriptors of every new region from its pixels
+class RecomputedDescriptorDistance {
+public:
+
+	RecomputedDescriptorDistance(HierarchyType& hierarchy, InputType& input) : _input(input) {
+		for (uint64 i = 0; i <= hierarchy.max_label(); i++) _calculate(hierarchy(i));
+	}
+
+	inline float64 operator()(RegionType& r1, RegionType& r2) {
+		return _link_distance(r1, r2);
+	}
+
+	inline void merge(RegionType& parent, RegionType& r1, RegionType& r2) {
+		r1.coll_vd().clear();
+		r2.coll_vd().clear();
+		_calculate(parent);
+	}
+
+protected:
+
+	void _calculate(RegionType& r) {
+		CollaborativeDescriptors& vd = r.coll_vd();
+		vd.calculate(new VDArea(), _input.colors_begin(r), _input.colors_end(r), &_input.coll_vd());
+		vd.calculate(new VDMeanValue<3>(), _input.colors_begin(r), _input.colors_end(r), &_input.coll_vd());
+		vd.calculate(new VDBoundingBox<2>(), _input.colors_begin(r), _input.colors_end(r), &_input.coll_vd());
+		vd.calculate(new VDHistogram<3,16>(), _input.colors_begin(r), _input.colors_end(r), &_input.coll_vd());
+	}
+
+	InputType& _input;
+	LinkDistanceType _link_distance;
+};
+
+//! Builds a whole BPT with a distance and reports the time and the descriptors of the root
+template<class DistanceType>
+void report(HierarchyType& h, DistanceType& distance, float64 t_init, const char* name) {
+	clock_t t = clock();
+	segmentation::BPTBuilder<HierarchyType, DistanceType> builder(h, distance);
+	uint64 merges = builder.build();
+	float64 t_build = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	RegionType& root = h(h.max_label());
+	const VDMeanValue<3>& mean = root.coll_vd().get(VDMeanValue<3>());
+	const VDBoundingBox<2>& bbox = root.coll_vd().get(VDBoundingBox<2>());
+	std::cout << name << " (" << merges << " merges)" << std::endl;
+	std::cout << "  leaves : " << t_init << " s" << std::endl;
+	std::cout << "  build  : " << t_build << " s" << std::endl;
+	std::cout << "  root   : area " << root.coll_vd().get(VDArea()).area() << ", mean (" << mean.mean(0) << "," << mean.mean(1) << "," << mean.mean(2)
+			  << "), box (" << bbox.min(0) << "," << bbox.min(1) << ")-(" << bbox.max(0) << "," << bbox.max(1) << ")" << std::endl;
+}
+
+//! Time to build a whole BPT keeping area, mean colour, bounding box and histogram of every region, combining the
+//! descriptors of the children at every merging or computing them again from the pixels
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 1000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 1000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 10;
+
+	// square leaves of random colour with noise
+	uint64 cols = (sx + block - 1) / block;
+	uint64 rows = (sy + block - 1) / block;
+	std::vector<float64> colours(3*cols*rows);
+	srand(0);
+	for (uint64 i = 0; i < colours.size(); i++) colours[i] = rand() % 240;
+
+	PartitionType leaves(sx,sy);
+	ImageType img(ImageType::coord_type(sx,sy));
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			uint64 l = (y/block)*cols + x/block;
+			leaves(x,y)(0) = l;
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = colours[3*l + c] + rand() % 16;
+		}
+	}
+	InputType input(img);
+	LinkDistanceType link_distance;
+
+	std::cout << "size " << sx << "x" << sy << ", " << cols*rows << " leaves" << std::endl;
+	{
+		HierarchyType h;
+		h.init(leaves);
+		clock_t t = clock();
+		segmentation::DescriptorDistance<HierarchyType, LinkDistanceType> distance(h, link_distance);
+		distance.add_descriptor(VDArea(), input);
+		distance.add_descriptor(VDMeanValue<3>(), input);
+		distance.add_descriptor(VDBoundingBox<2>(), input);
+		distance.add_descriptor(VDHistogram<3,16>(), input);
+		report(h, distance, float64(clock() - t) / CLOCKS_PER_SEC, "combined at merging");
+	}
+	{
+		HierarchyType h;
+		h.init(leaves);
+		clock_t t = clock();
+		RecomputedDescriptorDistance distance(h, input);
+		report(h, distance, float64(clock() - t) / CLOCKS_PER_SEC, "computed from pixels");
+	}
+	return 0;
+}
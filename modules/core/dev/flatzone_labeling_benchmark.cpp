@@ -0,0 +1,72 @@
+/*
+ * flatzone_labeling_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/signal.hpp>
+#include <imageplus/segmentation/partition/partition.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,uint8,2,3>				ImageType;
+typedef segmentation::Partition<uint32,2>	PartitionType;
+
+//! Compares the flood fill and the union-find flat zone labelling on a blocky image with noise
+template<ConnectivityType connectivity>
+bool compare(ImageType& img, const char* name) {
+	PartitionType flood(img.sizes()), uf(img.sizes());
+	uint64 N = img.sizes().prod();
+
+	clock_t t = clock();
+	flood.set_flatzone_labels_flood_fill<connectivity>(img);
+	float64 t_flood = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	uf.set_flatzone_labels<connectivity>(img);
+	float64 t_uf = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	const uint32* a = flood.data();
+	const uint32* b = uf.data();
+	for (uint64 i = 0; i < N; i++) {
+		if (a[i] != b[i]) {
+			std::cerr << name << " : labels differ at unit " << i << std::endl;
+			return false;
+		}
+	}
+
+	std::cout << name << " (" << uf.max_label() << " zones)" << std::endl;
+	std::cout << "  flood fill : " << 1e9*t_flood/N << " ns/pixel" << std::endl;
+	std::cout << "  union-find : " << 1e9*t_uf/N << " ns/pixel" << std::endl;
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 4000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 3000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 16;
+
+	// blocks of constant colour with 10% of noisy pixels
+	ImageType img(ImageType::coord_type(sx,sy));
+	srand(0);
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			uint8 v = (uint8)(((x/block) * 7 + (y/block) * 13) % 5);
+			if (rand() % 10 == 0) v = (uint8)(rand() % 5);
+			img(x,y).fill(v);
+		}
+	}
+
+	std::cout << "size " << sx << "x" << sy << std::endl;
+	if (!compare<Connectivity2D4>(img, "Connectivity2D4")) return 1;
+	if (!compare<Connectivity2D8>(img, "Connectivity2D8")) return 1;
+	return 0;
+}
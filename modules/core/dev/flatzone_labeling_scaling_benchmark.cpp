@@ -0,0 +1,80 @@
+/*
+ * flatzone_labeling_scaling_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/signal.hpp>
+#include <imageplus/segmentation/partition/partition.hpp>
+#include <imageplus/segmentation/partition/parallel_flatzone_labeling.hpp>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,uint8,3,3>				VolumeType;
+typedef segmentation::Partition<uint32,3>	PartitionType;
+
+//! Wall time of the flat zone labelling of a video volume from 1 to N threads
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 640;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 480;
+	uint64 sz = (argc > 3) ? atoi(argv[3]) : 100;
+	uint64 max_threads = (argc > 4) ? atoi(argv[4]) : boost::thread::hardware_concurrency();
+	uint64 N = sx*sy*sz;
+
+	// moving blocks of constant colour with 10% of noisy voxels
+	VolumeType vol(VolumeType::coord_type(sx,sy,sz));
+	srand(0);
+	for (uint64 z = 0; z < sz; z++) {
+		for (uint64 y = 0; y < sy; y++) {
+			for (uint64 x = 0; x < sx; x++) {
+				uint8 v = (uint8)((((x+z)/16) * 7 + (y/16) * 13) % 5);
+				if (rand() % 10 == 0) v = (uint8)(rand() % 5);
+				vol(x,y,z).fill(v);
+			}
+		}
+	}
+
+	std::cout << "size " << sx << "x" << sy << "x" << sz << std::endl;
+
+	PartitionType reference(vol.sizes());
+	float64 t_serial = 0;
+	for (uint64 threads = 1; threads <= max_threads; threads++) {
+		PartitionType p(vol.sizes());
+
+		boost::posix_time::ptime t = boost::posix_time::microsec_clock::universal_time();
+		if (threads == 1) {
+			p.set_flatzone_labels<Connectivity3D6>(vol);
+		} else {
+			p.set_max_label(segmentation::label_flatzones_parallel<Connectivity3D6>(p, vol, threads));
+		}
+		float64 elapsed = (boost::posix_time::microsec_clock::universal_time() - t).total_microseconds() * 1e-6;
+
+		if (threads == 1) {
+			reference = p;
+			t_serial = elapsed;
+		} else {
+			const uint32* a = reference.data();
+			const uint32* b = p.data();
+			for (uint64 i = 0; i < N; i++) {
+				if (a[i] != b[i]) {
+					std::cerr << threads << " threads : labels differ at unit " << i << std::endl;
+					return 1;
+				}
+			}
+		}
+
+		std::cout << threads << " threads : " << 1e9*elapsed/N << " ns/voxel, speedup " << t_serial/elapsed
+				  << " (" << p.max_label() << " zones)" << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * hierarchy_storage_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef segmentation::Partition<uint64,2>						PartitionType;
+typedef PartitionType::coord_type								coord_type;
+
+//! Builds a hierarchy over a grid of leaves merging the roots in FIFO order, and reports time and stored coordinates
+template<class RegionType>
+void run(PartitionType& leaves, const char* name) {
+	typedef segmentation::HierarchicalRegionPartition<RegionType>	HierarchyType;
+
+	HierarchyType h;
+	h.set_update_partition(false);
+
+	clock_t t = clock();
+	h.init(leaves);
+	float64 t_init = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	uint64 num_leaves = h.max_label() + 1;
+	std::deque<uint64> roots;
+	for (uint64 i = 0; i < num_leaves; i++) roots.push_back(i);
+
+	h.set_max_number_of_regions(2*num_leaves - 1);
+
+	t = clock();
+	uint64 label = num_leaves;
+	while (roots.size() > 1) {
+		uint64 r1 = roots.front(); roots.pop_front();
+		uint64 r2 = roots.front(); roots.pop_front();
+		h.merge_regions(h(r1), h(r2), label);
+		roots.push_back(label++);
+	}
+	float64 t_merge = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	// iterate all the coordinates of the root
+	t = clock();
+	uint64 sum = 0;
+	RegionType& root = h(roots.front());
+	for (typename RegionType::iterator it = root.begin(); it != root.end(); ++it) sum += (*it)(0);
+	float64 t_iter = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	uint64 stored = 0;
+	for (typename HierarchyType::global_iterator r = h.begin(); r != h.end(); ++r) stored += (*r).coordinates().size();
+
+	std::cout << name << std::endl;
+	std::cout << "  init              : " << t_init << " s" << std::endl;
+	std::cout << "  merges            : " << t_merge << " s (" << label - num_leaves << " merges)" << std::endl;
+	std::cout << "  root iteration    : " << t_iter << " s (" << sum << ")" << std::endl;
+	std::cout << "  stored coordinates: " << stored << " (" << stored*sizeof(coord_type)/(1024*1024) << " MB)" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+
+	// 1000 rectangular leaves (40x25 grid)
+	PartitionType leaves(sx,sy);
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			leaves(x,y)(0) = (y*25/sy)*40 + (x*40/sx);
+		}
+	}
+
+	std::cout << "size " << sx << "x" << sy << ", 1000 leaves" << std::endl;
+	run<HierarchicalRegion<coord_type> >(leaves, "label-sorted leaf array");
+	run<HierarchicalRegion<coord_type, std::deque<coord_type> > >(leaves, "per-region deques");
+	return 0;
+}
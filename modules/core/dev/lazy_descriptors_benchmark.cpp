@@ -0,0 +1,157 @@
+/*
+ * lazy_descriptors_benchmark.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/core/region_descriptors.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/bpt_builder.hpp>
+#include <imageplus/segmentation/partition/lazy_descriptors.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,float64,2,3>												ImageType;
+typedef segmentation::Partition<uint64,2>										PartitionType;
+typedef PartitionType::coord_type												coord_type;
+typedef HierarchicalRegion<coord_type>											RegionType;
+typedef segmentation::HierarchicalRegionPartition<RegionType>					HierarchyType;
+typedef segmentation::MeanValueDistance<RegionType, ImageType>					DistanceType;
+typedef SignalRegionInput<ImageType>											InputType;
+typedef VDHistogram<3,8>														DescriptorType;
+typedef segmentation::LazyDescriptor<DescriptorType, InputType, HierarchyType>	LazyType;
+
+//! Number of bins of a lazy descriptor different from the descriptor computed directly from the pixels of the region
+uint64 compare(LazyType& lazy, RegionType& r, InputType& input) {
+	DescriptorType direct;
+	direct.calculate(input.colors_begin(r), input.colors_end(r), NULL);
+	const DescriptorType& memoised = lazy.get(r);
+
+	uint64 errors = 0;
+	for (uint64 c = 0; c < 3; c++) {
+		for (uint64 b = 0; b < 8; b++) errors += (memoised.count(c,b) != direct.count(c,b));
+	}
+	return errors;
+}
+
+//! Marks a region and its descendants as removed
+void remove_subtree(RegionType& r, std::vector<bool>& alive) {
+	std::vector<RegionType*> to_look(1, &r);
+	while (!to_look.empty()) {
+		RegionType* s = to_look.back();
+		to_look.pop_back();
+		alive[s->label()] = false;
+		to_look.insert(to_look.end(), s->children().begin(), s->children().end());
+	}
+}
+
+//! Checks the descriptors of LazyDescriptor against the ones computed directly from the pixels, for random regions of
+//! a partial BPT with a small budget, after pruning some regions and after merging the remaining roots, and times
+//! the lazy and the direct computation
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 400;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 300;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 4;
+	uint64 budget = (argc > 4) ? atoi(argv[4]) : 256;
+	uint64 queries = (argc > 5) ? atoi(argv[5]) : 2000;
+
+	// square leaves of random colour with noise
+	uint64 cols = (sx + block - 1) / block;
+	srand(0);
+	PartitionType leaves(sx,sy);
+	ImageType img(ImageType::coord_type(sx,sy));
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			leaves(x,y)(0) = (y/block)*cols + x/block;
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = rand() % 256;
+		}
+	}
+
+	// BPT stopped at a few roots, which are merged later through the lazy descriptor
+	const uint64 roots = 8;
+	HierarchyType h;
+	h.init(leaves);
+	uint64 num_leaves = h.max_label() + 1;
+	DistanceType distance(h.leaves_partition(), img, num_leaves);
+	segmentation::BPTBuilder<HierarchyType, DistanceType> builder(h, distance);
+	builder.build(segmentation::StopAtNumberOfRegions(roots));
+
+	std::cout << "size " << sx << "x" << sy << ", " << h.max_label() + 1 << " regions, budget " << budget << std::endl;
+
+	InputType input(img);
+	LazyType lazy(h, input, DescriptorType(), budget);
+	std::vector<bool> alive(2*num_leaves - 1, false);
+	for (uint64 l = 0; l <= h.max_label(); l++) alive[l] = true;
+
+	// random regions, half of them near the top of the tree, where the memoised descendants are reused
+	uint64 errors = 0;
+	uint64 over_budget = 0;
+	std::vector<uint64> labels(queries);
+	for (uint64 q = 0; q < queries; q++) labels[q] = (rand() % 2) ? rand() % (h.max_label() + 1) : h.max_label() - rand() % 64;
+
+	clock_t t = clock();
+	for (uint64 q = 0; q < queries; q++) lazy.get(labels[q]);
+	float64 t_lazy = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	for (uint64 q = 0; q < queries; q++) {
+		DescriptorType direct;
+		direct.calculate(input.colors_begin(h(labels[q])), input.colors_end(h(labels[q])), NULL);
+	}
+	float64 t_direct = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	for (uint64 q = 0; q < queries; q++) {
+		errors += compare(lazy, h(labels[q]), input);
+		over_budget += (lazy.size() > budget);
+	}
+	std::cout << "queries : lazy " << t_lazy << " s, direct " << t_direct << " s" << std::endl;
+
+	// prune the children of some regions with memoised descriptors
+	for (uint64 p = 0; p < 20; p++) {
+		if (!alive[labels[p]] || h(labels[p]).children().empty()) continue;
+		RegionType& r = h(labels[p]);
+		lazy.get(r);
+		for (uint64 i = 0; i < r.children().size(); i++) remove_subtree(*r.child(i), alive);
+		lazy.prune(r);
+	}
+	for (uint64 q = 0; q < queries; q++) {
+		uint64 l = rand() % (h.max_label() + 1);
+		if (!alive[l]) continue;
+		errors += compare(lazy, h(l), input);
+		over_budget += (lazy.size() > budget);
+	}
+
+	// merge the roots, whose descriptors are memoised, two by two
+	std::vector<RegionType*> top;
+	for (uint64 l = 0; l <= h.max_label(); l++) {
+		if (alive[l] && h(l).parent() == NULL) top.push_back(&h(l));
+	}
+	for (uint64 i = 0; i < top.size(); i++) lazy.get(*top[i]);
+	uint64 merges = 0;
+	for (uint64 i = 0; i < top.size(); i++) {
+		RegionType* r = top[i];
+		if (r->parent() != NULL || r->neighbors_begin() == r->neighbors_end()) continue;
+		RegionType& neighbor = *static_cast<RegionType*>(*r->neighbors_begin());
+		const uint64 label = h.max_label() + 1;
+		alive[label] = true;
+		RegionType& parent = lazy.merge_regions(*r, neighbor, label);
+		errors += compare(lazy, parent, input);
+		errors += compare(lazy, *r, input);
+		top.push_back(&parent);
+		merges++;
+	}
+	std::cout << "pruned and merged " << merges << " roots" << std::endl;
+
+	std::cout << "mismatches : " << errors << ", over budget : " << over_budget << std::endl;
+	return (errors == 0 && over_budget == 0) ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/*
+ * leaf_statistics_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/core/region_descriptors.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/leaf_statistics.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,float64,2,3>												ImageType;
+typedef segmentation::Partition<uint64,2>										PartitionType;
+typedef PartitionType::coord_type												coord_type;
+typedef HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, FlatNeighborStorage<> >	RegionType;
+typedef segmentation::HierarchicalRegionPartition<RegionType>					HierarchyType;
+typedef segmentation::LeafStatistics<ImageType, 16>								StatisticsType;
+
+//! Time to compute area, mean colour, bounding box and histogram of all the leaves of a hierarchy, from the
+//! coordinates of every leaf (calc_descriptor) and from the statistics accumulated in one scan of the image
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 10;
+
+	// square leaves of random colour with noise
+	uint64 cols = (sx + block - 1) / block;
+	srand(0);
+	PartitionType leaves(sx,sy);
+	ImageType img(ImageType::coord_type(sx,sy));
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			leaves(x,y)(0) = (y/block)*cols + x/block;
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = rand() % 256;
+		}
+	}
+	float64 mpix = float64(sx*sy) / 1e6;
+
+	HierarchyType h1, h2;
+	h1.init(leaves);
+	h2.init(leaves);
+	uint64 num_leaves = h1.max_label() + 1;
+
+	SignalRegionInput<ImageType> input(img);
+	clock_t t = clock();
+	for (uint64 i = 0; i < num_leaves; i++) {
+		calc_descriptor(new VDArea(), input, h1(i));
+		calc_descriptor(new VDMeanValue<3>(), input, h1(i));
+		calc_descriptor(new VDBoundingBox<2>(), input, h1(i));
+		calc_descriptor(new VDHistogram<3,16>(), input, h1(i));
+	}
+	float64 t_coords = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	StatisticsType statistics;
+	statistics.accumulate(h2.leaves_partition(), img, num_leaves);
+	float64 t_scan = float64(clock() - t) / CLOCKS_PER_SEC;
+	seed_leaf_descriptors(VDArea(), statistics, h2);
+	seed_leaf_descriptors(VDMeanValue<3>(), statistics, h2);
+	seed_leaf_descriptors(VDBoundingBox<2>(), statistics, h2);
+	seed_leaf_descriptors(VDHistogram<3,16>(), statistics, h2);
+	float64 t_seed = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	// both ways must give the same descriptors
+	uint64 mismatches = 0;
+	for (uint64 i = 0; i < num_leaves; i++) {
+		CollaborativeDescriptors& d1 = h1(i).coll_vd();
+		CollaborativeDescriptors& d2 = h2(i).coll_vd();
+		if (d1.get(VDArea()).area() != d2.get(VDArea()).area()) mismatches++;
+		for (uint64 c = 0; c < 3; c++) {
+			if (d1.get(VDMeanValue<3>()).mean(c) != d2.get(VDMeanValue<3>()).mean(c)) mismatches++;
+			for (uint64 b = 0; b < 16; b++) if (d1.get(VDHistogram<3,16>()).count(c,b) != d2.get(VDHistogram<3,16>()).count(c,b)) mismatches++;
+		}
+		for (uint64 k = 0; k < 2; k++) {
+			if (d1.get(VDBoundingBox<2>()).min(k) != d2.get(VDBoundingBox<2>()).min(k)) mismatches++;
+			if (d1.get(VDBoundingBox<2>()).max(k) != d2.get(VDBoundingBox<2>()).max(k)) mismatches++;
+		}
+	}
+
+	std::cout << "size " << sx << "x" << sy << ", " << num_leaves << " leaves" << std::endl;
+	std::cout << "coordinates : " << t_coords << " s (" << mpix/t_coords << " MPix/s)" << std::endl;
+	std::cout << "scan        : " << t_scan << " s (" << mpix/t_scan << " MPix/s), " << t_seed << " s with the descriptors" << std::endl;
+	std::cout << "mismatches  : " << mismatches << std::endl;
+	return 0;
+}
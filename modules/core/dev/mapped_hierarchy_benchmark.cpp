@@ -0,0 +1,96 @@
+/*
+ * mapped_hierarchy_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/bpt_builder.hpp>
+#include <imageplus/segmentation/io/mapped_hierarchy.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,float64,2,3>												ImageType;
+typedef segmentation::Partition<uint64,2>										PartitionType;
+typedef PartitionType::coord_type												coord_type;
+typedef HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, FlatNeighborStorage<> >	RegionType;
+typedef segmentation::HierarchicalRegionPartition<RegionType>					HierarchyType;
+typedef segmentation::MeanValueDistance<RegionType, ImageType>					DistanceType;
+typedef segmentation::MappedHierarchy<PartitionType>							MappedType;
+
+//! Time to open a stored BPT with load_from_files and as a MappedHierarchy, and check that the view answers
+//! the same as the hierarchy
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 4;
+	std::string dir = (argc > 4) ? argv[4] : "/tmp";
+
+	// square leaves of random colour
+	uint64 cols = (sx + block - 1) / block;
+	std::vector<float64> colours(3*cols*((sy + block - 1) / block));
+	srand(0);
+	for (uint64 i = 0; i < colours.size(); i++) colours[i] = rand() % 256;
+
+	PartitionType leaves(sx,sy);
+	ImageType img(ImageType::coord_type(sx,sy));
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			uint64 l = (y/block)*cols + x/block;
+			leaves(x,y)(0) = l;
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = colours[3*l + c];
+		}
+	}
+
+	HierarchyType h;
+	h.init(leaves);
+	DistanceType distance(h.leaves_partition(), img, h.max_label() + 1);
+	segmentation::BPTBuilder<HierarchyType, DistanceType> builder(h, distance);
+	builder.build();
+
+	h.save_to_files(dir + "/hierarchy.part", dir + "/hierarchy.merg");
+	h.save_to_mapped_file(dir + "/hierarchy.map");
+
+	clock_t t = clock();
+	HierarchyType loaded;
+	loaded.load_from_files(dir + "/hierarchy.part", dir + "/hierarchy.merg");
+	float64 t_load = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	MappedType mapped(dir + "/hierarchy.map");
+	float64 t_open = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	// same parents, children and areas, and leaves of the root
+	uint64 errors = 0;
+	for (uint64 l = 0; l <= h.max_label(); l++) {
+		RegionType& r = h(l);
+		uint64 parent = (r.parent() == NULL) ? segmentation::no_region : r.parent()->label();
+		if (mapped.parent(l) != parent || mapped.num_children(l) != r.children().size()) errors++;
+		for (uint64 i = 0; i < r.children().size(); i++) {
+			if (mapped.child(l,i) != r.child(i)->label() || !mapped.is_descendant(r.child(i)->label(), l)) errors++;
+		}
+	}
+	uint64 root = h.max_label();
+	if (mapped.area(root) != sx*sy || mapped.num_leaves(root) != mapped.num_leaves() || mapped.max(root,0) != int64(sx) - 1) errors++;
+	t = clock();
+	uint64 sum = 0;
+	for (uint64 l = 0; l < mapped.num_leaves(); l++) sum += mapped.area(l);
+	float64 t_query = float64(clock() - t) / CLOCKS_PER_SEC;
+	if (sum != sx*sy) errors++;
+
+	std::cout << "size " << sx << "x" << sy << ", " << mapped.num_regions() << " regions, " << mapped.header().file_size / (1 << 20) << " MB" << std::endl;
+	std::cout << "load_from_files  : " << t_load << " s" << std::endl;
+	std::cout << "MappedHierarchy  : " << t_open << " s (area of all the leaves " << t_query << " s)" << std::endl;
+	std::cout << "mismatches       : " << errors << std::endl;
+	return errors != 0;
+}
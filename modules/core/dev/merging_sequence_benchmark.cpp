@@ -0,0 +1,124 @@
+/*
+ * merging_sequence_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/segmentation/io/merging_sequence_read.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+//! Callback summing the labels of the mergings
+struct Summer {
+	uint64 sum;
+	Summer() : sum(0) {
+	}
+	inline void operator()(uint64 son1, uint64 son2, uint64 father) {
+		sum += son1 + son2 + father;
+	}
+};
+
+//! Skips the partition and image paths of a PRL metadata file
+void skip_paths(std::ifstream& in) {
+	std::string partition_file, image_file;
+	in >> partition_file >> image_file;
+}
+
+//! Time to parse the merging sequence of a PRL metadata file with operator>> into a vector per merging (as
+//! PRLReader did before), into a flat array of triples and with a callback
+int main(int argc, char *argv[]) {
+	uint64 num_leaves = (argc > 1) ? atoi(argv[1]) : 2000000;
+	std::string path = (argc > 2) ? argv[2] : "/tmp/benchmark.txt";
+
+	// mergings of a random binary tree, labels from 1
+	std::vector<uint64> active(num_leaves);
+	for (uint64 i = 0; i < num_leaves; i++) active[i] = i + 1;
+	std::vector<uint64> expected;
+	{
+		std::ofstream out(path.c_str());
+		out << "partition.prl" << std::endl << "image.png" << std::endl;
+		srand(0);
+		uint64 next = num_leaves + 1;
+		while (active.size() > 1) {
+			// merge random pairs of neighbours
+			std::vector<uint64> merged;
+			for (uint64 i = 0; i < active.size(); i++) {
+				if (i + 1 < active.size() && rand() % 2 == 0) {
+					out << active[i] << "\t" << active[i+1] << "\t" << next << std::endl;
+					expected.push_back(active[i]);
+					expected.push_back(active[i+1]);
+					expected.push_back(next);
+					merged.push_back(next++);
+					i++;
+				} else {
+					merged.push_back(active[i]);
+				}
+			}
+			active.swap(merged);
+		}
+	}
+
+	clock_t t = clock();
+	std::vector<std::vector<uint64> > reference;
+	{
+		std::ifstream in(path.c_str());
+		skip_paths(in);
+		uint64 son1, son2, father;
+		in >> son1;
+		while (!in.eof()) {
+			in >> son2 >> father;
+			std::vector<uint64> merging(3);
+			merging[0] = son1; merging[1] = son2; merging[2] = father;
+			reference.push_back(merging);
+			in >> son1;
+		}
+	}
+	float64 t_reference = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	std::vector<uint64> triples;
+	{
+		std::ifstream in(path.c_str());
+		skip_paths(in);
+		segmentation::MergingSequenceReader reader(in);
+		reader.read(triples);
+	}
+	float64 t_flat = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	t = clock();
+	Summer summer;
+	uint64 count;
+	{
+		std::ifstream in(path.c_str());
+		skip_paths(in);
+		segmentation::MergingSequenceReader reader(in);
+		count = reader.for_each(summer);
+	}
+	float64 t_callback = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	uint64 errors = (triples != expected) + (count != reference.size());
+	uint64 sum = 0;
+	for (uint64 i = 0; i < reference.size(); i++) {
+		for (uint64 k = 0; k < 3; k++) {
+			errors += (reference[i][k] != expected[3*i + k]);
+			sum += reference[i][k];
+		}
+	}
+	errors += (sum != summer.sum);
+
+	std::cout << expected.size() / 3 << " mergings" << std::endl;
+	std::cout << "operator>>, vector per merging : " << t_reference << " s" << std::endl;
+	std::cout << "flat array                     : " << t_flat << " s" << std::endl;
+	std::cout << "callback                       : " << t_callback << " s" << std::endl;
+	std::cout << "mismatches                     : " << errors << std::endl;
+	return errors != 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * neighbor_container_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef segmentation::Partition<uint64,2>						PartitionType;
+typedef PartitionType::coord_type								coord_type;
+
+//! Builds a hierarchy merging neighboring roots, and reports the time and the number of links of the leaves
+template<class RegionType>
+void run(PartitionType& leaves, uint64 repetitions, const char* name) {
+	typedef segmentation::HierarchicalRegionPartition<RegionType>	HierarchyType;
+
+	float64 t_init = 0, t_merge = 0;
+	uint64 merges = 0, links = 0;
+	for (uint64 k = 0; k < repetitions; k++) {
+		HierarchyType h;
+		h.set_update_partition(false);
+
+		clock_t t = clock();
+		h.init(leaves);
+		t_init += float64(clock() - t) / CLOCKS_PER_SEC;
+
+		uint64 num_leaves = h.max_label() + 1;
+		h.set_max_number_of_regions(2*num_leaves - 1);
+
+		links = 0;
+		for (uint64 i = 0; i < num_leaves; i++) {
+			RegionType& r = h(i);
+			for (typename RegionType::neighbor_iterator n = r.neighbors_begin(); n != r.neighbors_end(); ++n) links++;
+		}
+
+		// merge every root with its neighbor of lowest label
+		t = clock();
+		std::deque<uint64> roots;
+		for (uint64 i = 0; i < num_leaves; i++) roots.push_back(i);
+
+		uint64 label = num_leaves;
+		while (!roots.empty()) {
+			RegionType& r = h(roots.front());
+			roots.pop_front();
+			if (r.parent() != NULL || r.neighbors_begin() == r.neighbors_end()) continue;
+
+			typename RegionType::neighbor_iterator n = r.neighbors_begin();
+			typename RegionType::RegionBaseType* best = *n;
+			for (; n != r.neighbors_end(); ++n) {
+				if ((*n)->label() < best->label()) best = *n;
+			}
+			h.merge_regions(r, static_cast<RegionType&>(*best), label);
+			roots.push_back(label++);
+		}
+		merges = label - num_leaves;
+		t_merge += float64(clock() - t) / CLOCKS_PER_SEC;
+	}
+
+	std::cout << name << " (" << links/2 << " leaf links, " << merges << " merges)" << std::endl;
+	std::cout << "  init   : " << t_init/repetitions << " s" << std::endl;
+	std::cout << "  merges : " << t_merge/repetitions << " s" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 10;
+	uint64 repetitions = (argc > 4) ? atoi(argv[4]) : 3;
+
+	// square leaves of block x block pixels
+	PartitionType leaves(sx,sy);
+	uint64 cols = (sx + block - 1) / block;
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			leaves(x,y)(0) = (y/block)*cols + x/block;
+		}
+	}
+
+	std::cout << "size " << sx << "x" << sy << ", " << cols*((sy + block - 1) / block) << " leaves" << std::endl;
+	run<HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, MapNeighborStorage> >(leaves, repetitions, "std::map neighbors");
+	run<HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, FlatNeighborStorage<> > >(leaves, repetitions, "flat neighbors");
+	return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * parallel_descriptors_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/core/region_descriptors.hpp>
+#include <imageplus/core/parallel_descriptors.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/bpt_builder.hpp>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,float64,2,3>												ImageType;
+typedef segmentation::Partition<uint64,2>										PartitionType;
+typedef PartitionType::coord_type												coord_type;
+typedef HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, FlatNeighborStorage<> >	RegionType;
+typedef segmentation::HierarchicalRegionPartition<RegionType>					HierarchyType;
+typedef segmentation::MeanValueDistance<RegionType, ImageType>					DistanceType;
+
+//! Wall time to compute the mean colour and the histogram of the root of a whole BPT (and so of all its regions)
+//! from 1 to N threads
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 4;
+	uint64 max_threads = (argc > 4) ? atoi(argv[4]) : boost::thread::hardware_concurrency();
+
+	// square leaves of random colour with noise
+	uint64 cols = (sx + block - 1) / block;
+	srand(0);
+	PartitionType leaves(sx,sy);
+	ImageType img(ImageType::coord_type(sx,sy));
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			leaves(x,y)(0) = (y/block)*cols + x/block;
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = rand() % 256;
+		}
+	}
+
+	HierarchyType h;
+	h.init(leaves);
+	DistanceType distance(h.leaves_partition(), img, h.max_label() + 1);
+	segmentation::BPTBuilder<HierarchyType, DistanceType> builder(h, distance);
+	builder.build();
+	RegionType& root = h(h.max_label());
+
+	std::cout << "size " << sx << "x" << sy << ", " << h.max_label() + 1 << " regions" << std::endl;
+
+	SignalRegionInput<ImageType> input(img);
+	float64 t_serial = 0;
+	VDMeanValue<3> reference_mean;
+	VDHistogram<3,16> reference_histogram;
+	for (uint64 threads = 1; threads <= max_threads; threads++) {
+		for (uint64 l = 0; l <= h.max_label(); l++) h(l).coll_vd().clear();
+
+		boost::posix_time::ptime t = boost::posix_time::microsec_clock::universal_time();
+		const VDMeanValue<3>& mean = calc_descriptor(new VDMeanValue<3>(), input, root, threads);
+		const VDHistogram<3,16>& histogram = calc_descriptor(new VDHistogram<3,16>(), input, root, threads);
+		float64 elapsed = (boost::posix_time::microsec_clock::universal_time() - t).total_microseconds() * 1e-6;
+
+		if (threads == 1) {
+			reference_mean = mean;
+			reference_histogram = histogram;
+			t_serial = elapsed;
+		} else {
+			for (uint64 c = 0; c < 3; c++) {
+				bool same = mean.mean(c) == reference_mean.mean(c);
+				for (uint64 b = 0; b < 16; b++) same = same && histogram.count(c,b) == reference_histogram.count(c,b);
+				if (!same) {
+					std::cerr << threads << " threads : descriptors differ" << std::endl;
+					return 1;
+				}
+			}
+		}
+
+		std::cout << threads << " threads : " << elapsed << " s, speedup " << t_serial/elapsed << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * partition3d_codec_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/config.hpp>
+#include <imageplus/segmentation/partition/partition.hpp>
+#include <imageplus/segmentation/io/partition3d_write.hpp>
+#include <imageplus/segmentation/io/partition3d_read.hpp>
+
+#include <cmath>
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef segmentation::Partition<uint32,3>		PartitionType;
+typedef segmentation::Partition<uint32,2>		FrameType;
+
+//! Supervoxel-like partition: Voronoi cells of seeds on a jittered grid that drift over time, with seeds
+//! replaced by new ones (with a new label) from time to time
+PartitionType make_supervoxels(uint64 sx, uint64 sy, uint64 sz, uint64 cell) {
+	const uint64 cols = (sx + cell - 1) / cell;
+	const uint64 rows = (sy + cell - 1) / cell;
+	std::vector<float64> x(cols*rows), y(cols*rows), vx(cols*rows), vy(cols*rows);
+	std::vector<uint32> labels(cols*rows);
+	uint32 next_label = 0;
+	srand(0);
+	for (uint64 i = 0; i < cols*rows; i++) {
+		x[i] = (i % cols + rand() / (RAND_MAX + 1.0)) * cell;
+		y[i] = (i / cols + rand() / (RAND_MAX + 1.0)) * cell;
+		vx[i] = (rand() / (RAND_MAX + 1.0) - 0.5) * 0.3;
+		vy[i] = (rand() / (RAND_MAX + 1.0) - 0.5) * 0.3;
+		labels[i] = next_label++;
+	}
+
+	PartitionType p(sx,sy,sz);
+	for (uint64 t = 0; t < sz; t++) {
+		for (uint64 py = 0; py < sy; py++) {
+			for (uint64 px = 0; px < sx; px++) {
+				// nearest seed of the 3x3 cells around
+				const int64 cx = px / cell, cy = py / cell;
+				float64 best = 1e30;
+				uint32 label = 0;
+				for (int64 j = std::max<int64>(cy - 1, 0); j <= std::min<int64>(cy + 1, rows - 1); j++) {
+					for (int64 i = std::max<int64>(cx - 1, 0); i <= std::min<int64>(cx + 1, cols - 1); i++) {
+						const uint64 s = j*cols + i;
+						const float64 d = (x[s] - px)*(x[s] - px) + (y[s] - py)*(y[s] - py);
+						if (d < best) { best = d; label = labels[s]; }
+					}
+				}
+				p(px,py,t)(0) = label;
+			}
+		}
+
+		// drift inside the cell of the seed, and renew some seeds
+		for (uint64 i = 0; i < cols*rows; i++) {
+			const float64 x0 = (i % cols) * cell, y0 = (i / cols) * cell;
+			x[i] = std::min(std::max(x[i] + vx[i], x0), x0 + cell - 1);
+			y[i] = std::min(std::max(y[i] + vy[i], y0), y0 + cell - 1);
+			if (rand() % 200 == 0) labels[i] = next_label++;
+		}
+	}
+	return p;
+}
+
+//! Compression ratio and decoding throughput of PRL3DWriter / PRL3DReader on a supervoxel partition, synthetic
+//! or read from a file written with Partition::write_partition
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 640;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 360;
+	uint64 sz = (argc > 3) ? atoi(argv[3]) : 100;
+	std::string input = (argc > 4) ? argv[4] : "";
+	std::string path = "/tmp/benchmark.prl3d";
+
+	PartitionType p;
+	if (input.empty()) {
+		p = make_supervoxels(sx, sy, sz, 24);
+	} else {
+		p.read_partition(input);
+		sx = p.size_x(); sy = p.size_y(); sz = p.sizes()(2);
+	}
+	const float64 raw_mb = float64(sx*sy*sz*sizeof(uint32)) / (1 << 20);
+	std::cout << "size " << sx << "x" << sy << "x" << sz << ", raw " << raw_mb << " MB" << std::endl;
+
+	uint64 errors = 0;
+	const uint64 intervals[] = {1, 16};
+	for (uint64 k = 0; k < 2; k++) {
+		segmentation::PRL3DWriter<PartitionType> writer(intervals[k]);
+		clock_t t = clock();
+		writer.write(p, path);
+		float64 t_write = float64(clock() - t) / CLOCKS_PER_SEC;
+
+		segmentation::PRL3DReader<PartitionType> reader(path);
+		std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+		const float64 mb = float64(file.tellg()) / (1 << 20);
+
+		t = clock();
+		PartitionType decoded = reader.read();
+		float64 t_read = float64(clock() - t) / CLOCKS_PER_SEC;
+
+		// every frame on its own (the last of a key interval is the slowest)
+		t = clock();
+		uint64 frame = std::min<uint64>(sz - 1, intervals[k] - 1 + intervals[k]*(sz / intervals[k] / 2));
+		FrameType single = reader.read_frame<FrameType>(frame);
+		float64 t_frame = float64(clock() - t) / CLOCKS_PER_SEC;
+
+		for (uint64 z = 0; z < sz; z++) {
+			for (uint64 y = 0; y < sy; y++) {
+				for (uint64 x = 0; x < sx; x++) errors += (decoded(x,y,z)(0) != p(x,y,z)(0));
+			}
+		}
+		for (uint64 y = 0; y < sy; y++) {
+			for (uint64 x = 0; x < sx; x++) errors += (single(x,y)(0) != p(x,y,frame)(0));
+		}
+
+		std::cout << "key interval " << intervals[k] << ": " << mb << " MB, ratio " << raw_mb / mb << std::endl;
+		std::cout << "  write " << raw_mb / t_write << " MB/s, read " << raw_mb / t_read << " MB/s (" << sx*sy*sz / t_read / 1e6 << " MPix/s), frame "
+				  << frame << " alone " << t_frame * 1e3 << " ms" << std::endl;
+	}
+	std::cout << "mismatches : " << errors << std::endl;
+	return errors != 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * prl_read_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/config.hpp>
+#include <imageplus/segmentation/partition/partition.hpp>
+#include <imageplus/segmentation/io/partition2d_write.hpp>
+#include <imageplus/segmentation/io/partition2d_read.hpp>
+#include <imageplus/segmentation/io/readbitstream.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef segmentation::Partition<uint32,2>		PartitionType;
+typedef segmentation::Partition<uint64,2>		Partition64Type;
+
+//! Decoder reading the bitstream bit by bit with ReadBitStream (as PRLReader did before)
+void reference_read(const std::string& path, PartitionType& m) {
+	std::ifstream fp(path.c_str(), std::ios::in | std::ios::binary);
+	fp.seekg(29);
+	uint8 num_bits;
+	fp.read((char*)&num_bits, 1);
+	fp.close();
+
+	segmentation::ReadBitStream<2> rbs(path.c_str());
+	rbs.seekg(112+64*2);
+
+	uint32* pointer = m.data();
+	const uint64 total = m.size_x() * m.size_y();
+	const uint64 width = m.size_x();
+	uint64 num_read = 0;
+	uint32 max_label = 0;
+	uint32 label;
+	while (num_read < total) {
+		if (rbs.read(1) == 0) {
+			label = *(pointer - width);
+		} else if (rbs.read(1) == 0) {
+			const uint32* up = pointer - width;
+			const uint32* up_right = up + 1;
+			while (*up == *up_right) up_right++;
+			label = *up_right;
+		} else if (rbs.read(1) == 0) {
+			label = ++max_label;
+		} else {
+			label = (uint32)rbs.read(num_bits);
+			if (label > max_label) max_label = label;
+		}
+
+		uint64 length = (rbs.read(1) == 1) ? rbs.read(8) : rbs.read(2) + 1;
+		for (uint64 i = 0; i < length; i++) *pointer++ = label;
+		num_read += length;
+	}
+}
+
+//! Decoding throughput of PRLReader and of a bit by bit decoder on a large PRL file
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 4000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 3000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 6;
+	std::string path = (argc > 4) ? argv[4] : "/tmp/benchmark.prl";
+	uint64 repetitions = 5;
+
+	// blocks of random labels with random horizontal offsets per row, so all the codes appear
+	uint64 cols = (sx + block - 1) / block + 1;
+	std::vector<uint32> block_labels(cols*((sy + block - 1) / block));
+	srand(0);
+	for (uint64 i = 0; i < block_labels.size(); i++) block_labels[i] = (rand() % 4 == 0) ? rand() % block_labels.size() : i;
+	PartitionType p(sx,sy);
+	for (uint64 y = 0; y < sy; y++) {
+		uint64 shift = rand() % 3;
+		for (uint64 x = 0; x < sx; x++) p(x,y)(0) = block_labels[(y/block)*cols + (x + shift)/block];
+	}
+
+	segmentation::PRLWriter<PartitionType> writer;
+	writer.write(p, path);
+	std::ifstream f(path.c_str(), std::ios::binary | std::ios::ate);
+	float64 mb = float64(f.tellg()) / (1 << 20);
+
+	// both include the allocation of the partition
+	PartitionType reference;
+	clock_t t = clock();
+	for (uint64 r = 0; r < repetitions; r++) {
+		reference = PartitionType(sx,sy);
+		reference_read(path, reference);
+	}
+	float64 t_reference = float64(clock() - t) / CLOCKS_PER_SEC / repetitions;
+
+	segmentation::PRLReader<PartitionType> reader;
+	PartitionType decoded;
+	t = clock();
+	for (uint64 r = 0; r < repetitions; r++) decoded = reader.read_prl(path);
+	float64 t_table = float64(clock() - t) / CLOCKS_PER_SEC / repetitions;
+
+	segmentation::PRLReader<Partition64Type> reader64;
+	Partition64Type decoded64 = reader64.read_prl(path);
+
+	uint64 errors = 0;
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			if (decoded(x,y)(0) != p(x,y)(0) || reference(x,y)(0) != p(x,y)(0) || decoded64(x,y)(0) != p(x,y)(0)) errors++;
+		}
+	}
+
+	std::cout << "size " << sx << "x" << sy << ", " << mb << " MB" << std::endl;
+	std::cout << "bit by bit : " << mb / t_reference << " MB/s, " << sx*sy / t_reference / 1e6 << " MPix/s" << std::endl;
+	std::cout << "PRLReader  : " << mb / t_table << " MB/s, " << sx*sy / t_table / 1e6 << " MPix/s" << std::endl;
+	std::cout << "mismatches : " << errors << std::endl;
+	return errors != 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * prl_write_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/config.hpp>
+#include <imageplus/segmentation/partition/partition.hpp>
+#include <imageplus/segmentation/io/partition2d_write.hpp>
+#include <imageplus/segmentation/io/partition2d_read.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef segmentation::Partition<uint32,2>		PartitionType;
+typedef segmentation::Partition<uint64,2>		Partition64Type;
+
+//! Length code of the PRL format
+void reference_length(uint64 length, segmentation::WriteBitStream<segmentation::APPEND>& wbs) {
+	if (length <= 4) wbs.write(length - 1, 3);
+	else wbs.write(256 + length, 9);
+}
+
+//! Encoder copying the partition and writing the bitstream a byte at a time with WriteBitStream (as PRLWriter did before)
+void reference_write(PartitionType& partition, const std::string& path) {
+	PartitionType m(partition.sizes());
+	PartitionType::iterator p = m.begin();
+	PartitionType::iterator p_end = m.end();
+	for (; p != p_end; ++p) (*p)(0) = partition(p.pos())(0);
+
+	const uint32* input = m.data();
+	const uint64 width = m.size_x();
+	const uint64 num_elements = m.size_x() * m.size_y();
+	uint32 max_value = 0;
+	for (uint64 i = 0; i < num_elements; i++) max_value = std::max(max_value, input[i]);
+	const uint8 num_bits = (uint8)ceil(log((float64)(max_value+1))/log(2.));
+
+	std::ofstream fp(path.c_str(), std::ios::out | std::ios::binary);
+	uint8 c = 1, dt = (uint8)segmentation::UINT32;
+	uint64 d = 2, sx = m.size_x(), sy = m.size_y();
+	fp.write((char*)&segmentation::MULT_MAGIC_NUMBER, 2);
+	fp.write((char*)&segmentation::MULT_FILETYPE, 1);
+	fp.write((char*)&c, 1);
+	fp.write((char*)&dt, 1);
+	fp.write((char*)&d, 8);
+	fp.write((char*)&sx, 8);
+	fp.write((char*)&sy, 8);
+	fp.write((char*)&num_bits, 1);
+	fp.close();
+
+	segmentation::WriteBitStream<segmentation::APPEND> wbs(path.c_str());
+	uint32 current_label = *input;
+	uint32 max_label = current_label;
+	uint64 current_length = 0;
+	wbs.write(((uint64)7 << num_bits) + current_label, num_bits + 3);
+	for (uint64 ii = 0; ii < num_elements; ii++, input++) {
+		if (*input == current_label && current_length < 255) {
+			current_length++;
+			continue;
+		}
+		reference_length(current_length, wbs);
+		current_label = *input;
+		current_length = 1;
+
+		bool found = false;
+		uint8 num_changes = 0;
+		if (ii >= width) {
+			uint32 ref_label1 = *(input - width);
+			uint32 offset = 0;
+			do {
+				uint32 ref_label2 = ref_label1;
+				ref_label1 = *(input - width + offset);
+				if (ref_label1 != ref_label2) num_changes++;
+				if (ref_label1 == current_label) found = true;
+				offset++;
+			} while (num_changes < 1 && ((ii + offset) % width > 0) && !found);
+		}
+		if (found) wbs.write(num_changes == 0 ? 0 : 2, num_changes == 0 ? 1 : 2);
+		else if (current_label - max_label == 1) wbs.write(6, 3);
+		else wbs.write(((uint64)7 << num_bits) + current_label, num_bits + 3);
+		if (max_label < current_label) max_label = current_label;
+	}
+	reference_length(current_length, wbs);
+	wbs.close();
+}
+
+//! Contents of a file
+std::string file_contents(const std::string& path) {
+	std::ifstream f(path.c_str(), std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+//! Partition of blocks of random labels with random horizontal offsets per row, so all the codes appear
+PartitionType make_partition(uint64 sx, uint64 sy, uint64 block) {
+	uint64 cols = (sx + 2) / block + 1;
+	std::vector<uint32> block_labels(cols*((sy + block - 1) / block));
+	for (uint64 i = 0; i < block_labels.size(); i++) block_labels[i] = (rand() % 4 == 0) ? rand() % block_labels.size() : i;
+	PartitionType p(sx,sy);
+	for (uint64 y = 0; y < sy; y++) {
+		uint64 shift = rand() % 3;
+		for (uint64 x = 0; x < sx; x++) p(x,y)(0) = block_labels[(y/block)*cols + (x + shift)/block];
+	}
+	return p;
+}
+
+//! Checks that a partition is written as before and read back unchanged, as uint32 and uint64 labels
+uint64 round_trip(PartitionType& p, const std::string& path) {
+	segmentation::PRLWriter<PartitionType> writer;
+	writer.write(p, path);
+	std::string written = file_contents(path);
+	reference_write(p, path);
+	uint64 errors = (written != file_contents(path));
+
+	Partition64Type p64(p.size_x(), p.size_y());
+	for (uint64 y = 0; y < p.size_y(); y++) for (uint64 x = 0; x < p.size_x(); x++) p64(x,y)(0) = p(x,y)(0);
+	segmentation::PRLWriter<Partition64Type> writer64;
+	writer64.write(p64, path);
+	errors += (written != file_contents(path));
+
+	segmentation::PRLReader<PartitionType> reader;
+	PartitionType decoded = reader.read_prl(path);
+	for (uint64 y = 0; y < p.size_y(); y++) for (uint64 x = 0; x < p.size_x(); x++) errors += (decoded(x,y)(0) != p(x,y)(0));
+	return errors;
+}
+
+//! Encoding throughput of PRLWriter and of the byte at a time encoder, and round trips with PRLReader
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 4000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 3000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 6;
+	std::string path = (argc > 4) ? argv[4] : "/tmp/benchmark.prl";
+	uint64 repetitions = 5;
+
+	srand(0);
+	uint64 errors = 0;
+	const uint64 shapes[][3] = {{1,1,1}, {1,7,1}, {7,1,2}, {300,2,1}, {33,20,1}, {33,20,3}, {640,480,5}, {257,3,300}};
+	for (uint64 i = 0; i < sizeof(shapes)/sizeof(shapes[0]); i++) {
+		PartitionType p = make_partition(shapes[i][0], shapes[i][1], shapes[i][2]);
+		errors += round_trip(p, path);
+	}
+
+	PartitionType p = make_partition(sx, sy, block);
+	errors += round_trip(p, path);
+
+	clock_t t = clock();
+	for (uint64 r = 0; r < repetitions; r++) reference_write(p, path);
+	float64 t_reference = float64(clock() - t) / CLOCKS_PER_SEC / repetitions;
+
+	segmentation::PRLWriter<PartitionType> writer;
+	t = clock();
+	for (uint64 r = 0; r < repetitions; r++) writer.write(p, path);
+	float64 t_buffered = float64(clock() - t) / CLOCKS_PER_SEC / repetitions;
+	float64 mb = float64(file_contents(path).size()) / (1 << 20);
+
+	std::cout << "size " << sx << "x" << sy << ", " << mb << " MB" << std::endl;
+	std::cout << "byte at a time : " << mb / t_reference << " MB/s, " << sx*sy / t_reference / 1e6 << " MPix/s" << std::endl;
+	std::cout << "PRLWriter      : " << mb / t_buffered << " MB/s, " << sx*sy / t_buffered / 1e6 << " MPix/s" << std::endl;
+	std::cout << "mismatches     : " << errors << std::endl;
+	return errors != 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * region_allocation_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef segmentation::Partition<uint64,2>						PartitionType;
+typedef PartitionType::coord_type								coord_type;
+
+//! Builds and destroys a hierarchy merging neighboring roots, and reports the time of every stage
+template<class RegionType>
+void run(PartitionType& leaves, uint64 repetitions, const char* name) {
+	typedef segmentation::HierarchicalRegionPartition<RegionType>	HierarchyType;
+
+	float64 t_build = 0, t_teardown = 0;
+	uint64 merges = 0;
+	for (uint64 k = 0; k < repetitions; k++) {
+		HierarchyType* h = new HierarchyType();
+		h->set_update_partition(false);
+
+		clock_t t = clock();
+		h->init(leaves);
+
+		uint64 num_leaves = h->max_label() + 1;
+		h->set_max_number_of_regions(2*num_leaves - 1);
+
+		// merge every root with its first neighbor
+		std::deque<uint64> roots;
+		for (uint64 i = 0; i < num_leaves; i++) roots.push_back(i);
+
+		uint64 label = num_leaves;
+		while (!roots.empty()) {
+			RegionType& r = (*h)(roots.front());
+			roots.pop_front();
+			if (r.parent() != NULL || r.neighbors_begin() == r.neighbors_end()) continue;
+
+			RegionType& n = static_cast<RegionType&>(**r.neighbors_begin());
+			h->merge_regions(r, n, label);
+			roots.push_back(label++);
+		}
+		merges = label - num_leaves;
+		t_build += float64(clock() - t) / CLOCKS_PER_SEC;
+
+		t = clock();
+		delete h;
+		t_teardown += float64(clock() - t) / CLOCKS_PER_SEC;
+	}
+
+	std::cout << name << " (" << merges << " merges)" << std::endl;
+	std::cout << "  build    : " << t_build/repetitions << " s" << std::endl;
+	std::cout << "  teardown : " << t_teardown/repetitions << " s" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 10;
+	uint64 repetitions = (argc > 4) ? atoi(argv[4]) : 3;
+
+	// square leaves of block x block pixels
+	PartitionType leaves(sx,sy);
+	uint64 cols = (sx + block - 1) / block;
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			leaves(x,y)(0) = (y/block)*cols + x/block;
+		}
+	}
+
+	std::cout << "size " << sx << "x" << sy << ", " << cols*((sy + block - 1) / block) << " leaves" << std::endl;
+	run<HierarchicalRegion<coord_type, CoordContainerView<coord_type>, HeapAllocation> >(leaves, repetitions, "new/delete");
+	run<HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation> >(leaves, repetitions, "arena");
+	return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * region_feature_table_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/core/region_descriptors.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/bpt_builder.hpp>
+#include <imageplus/segmentation/partition/region_feature_table.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,float64,2,3>												ImageType;
+typedef segmentation::Partition<uint64,2>										PartitionType;
+typedef PartitionType::coord_type												coord_type;
+typedef HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, FlatNeighborStorage<> >	RegionType;
+typedef segmentation::HierarchicalRegionPartition<RegionType>					HierarchyType;
+typedef segmentation::MeanValueDistance<RegionType, ImageType>					DistanceType;
+typedef segmentation::RegionFeatureTable<HierarchyType, ImageType>				TableType;
+
+//! Time to compute area, mean colour and bounding box of all the regions of a whole BPT with the feature table
+//! and with the descriptors of every region (calc_descriptor)
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 2000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 2000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 10;
+
+	// square leaves of random colour
+	uint64 cols = (sx + block - 1) / block;
+	uint64 rows = (sy + block - 1) / block;
+	std::vector<float64> colours(3*cols*rows);
+	srand(0);
+	for (uint64 i = 0; i < colours.size(); i++) colours[i] = rand() % 256;
+
+	PartitionType leaves(sx,sy);
+	ImageType img(ImageType::coord_type(sx,sy));
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			uint64 l = (y/block)*cols + x/block;
+			leaves(x,y)(0) = l;
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = colours[3*l + c];
+		}
+	}
+
+	HierarchyType h;
+	h.init(leaves);
+	DistanceType distance(h.leaves_partition(), img, h.max_label() + 1);
+	segmentation::BPTBuilder<HierarchyType, DistanceType> builder(h, distance);
+	builder.build();
+	uint64 root = h.max_label();
+
+	clock_t t = clock();
+	TableType table(h, img);
+	float64 t_table = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	SignalRegionInput<ImageType> input(img);
+	t = clock();
+	calc_descriptor(new VDArea(), input, h(root));
+	calc_descriptor(new VDMeanValue<3>(), input, h(root));
+	calc_descriptor(new VDBoundingBox<2>(), input, h(root));
+	float64 t_descriptors = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	const VDMeanValue<3>& mean = h(root).coll_vd().get(VDMeanValue<3>());
+	const VDBoundingBox<2>& bbox = h(root).coll_vd().get(VDBoundingBox<2>());
+
+	std::cout << "size " << sx << "x" << sy << ", " << table.size() << " regions" << std::endl;
+	std::cout << "feature table : " << t_table << " s" << std::endl;
+	std::cout << "  root area " << table.area()[root] << ", mean (" << table.mean(root,0) << "," << table.mean(root,1) << "," << table.mean(root,2)
+			  << "), box (" << table.min(0)[root] << "," << table.min(1)[root] << ")-(" << table.max(0)[root] << "," << table.max(1)[root]
+			  << "), centroid (" << table.centroid(root,0) << "," << table.centroid(root,1) << ")" << std::endl;
+	std::cout << "descriptors   : " << t_descriptors << " s" << std::endl;
+	std::cout << "  root area " << h(root).coll_vd().get(VDArea()).area() << ", mean (" << mean.mean(0) << "," << mean.mean(1) << "," << mean.mean(2)
+			  << "), box (" << bbox.min(0) << "," << bbox.min(1) << ")-(" << bbox.max(0) << "," << bbox.max(1) << ")" << std::endl;
+	return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * signal_access_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/signal.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <vector>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64, float64, 2, 3>	SignalType;
+
+//! Cost per access of Signal::operator() for sequential and random coordinates
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 4000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 3000;
+	uint64 N = sx*sy;
+
+	SignalType s(SignalType::coord_type(sx,sy));
+
+	// sequential access, coordinates as scalars
+	clock_t t = clock();
+	float64 sum = 0;
+	for (uint64 y = 0; y < sy; y++)
+		for (uint64 x = 0; x < sx; x++)
+			sum += s(x,y)(0);
+	float64 t_seq = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	// sequential access, coordinates as vectors
+	t = clock();
+	SignalType::coord_type c;
+	for (c(1) = 0; c(1) < (int64)sy; c(1)++)
+		for (c(0) = 0; c(0) < (int64)sx; c(0)++)
+			sum += s(c)(0);
+	float64 t_seq_coord = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	// random access
+	std::vector<int64> xs(N), ys(N);
+	srand(0);
+	for (uint64 i = 0; i < N; i++) {
+		xs[i] = rand() % sx;
+		ys[i] = rand() % sy;
+	}
+
+	t = clock();
+	for (uint64 i = 0; i < N; i++)
+		sum += s(xs[i],ys[i])(0);
+	float64 t_rand = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	std::cout << "size " << sx << "x" << sy << " (" << sum << ")" << std::endl;
+	std::cout << "sequential (x,y)  : " << 1e9*t_seq/N << " ns/access" << std::endl;
+	std::cout << "sequential coord  : " << 1e9*t_seq_coord/N << " ns/access" << std::endl;
+	std::cout << "random (x,y)      : " << 1e9*t_rand/N << " ns/access" << std::endl;
+}
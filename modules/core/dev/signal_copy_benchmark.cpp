@@ -0,0 +1,80 @@
+/*
+ * signal_copy_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+#include <imageplus/core/regions/hierarchical_region.hpp>
+#include <imageplus/core/region_descriptors.hpp>
+#include <imageplus/segmentation/partition/hierarchical_region_partition.hpp>
+#include <imageplus/segmentation/partition/bpt_builder.hpp>
+#include <imageplus/segmentation/partition/descriptor_merging.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef Signal<int64,float64,2,3>												ImageType;
+typedef segmentation::Partition<uint64,2>										PartitionType;
+typedef PartitionType::coord_type												coord_type;
+typedef HierarchicalRegion<coord_type, CoordContainerView<coord_type>, ArenaAllocation, FlatNeighborStorage<> >	RegionType;
+typedef segmentation::HierarchicalRegionPartition<RegionType>					HierarchyType;
+typedef SignalRegionInput<ImageType>											InputType;
+typedef segmentation::WardMeanValueDistance<3>									LinkDistanceType;
+
+//! Reads a signal passed by value (const, so the shared data is not copied)
+float64 first_value(const ImageType img) {
+	return img(0,0)(0);
+}
+
+//! Bytes of signal data copied while building a BPT (hierarchy initialization, descriptors and mergings), and time
+//! to pass a signal by value
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 1000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 1000;
+	uint64 block = (argc > 3) ? atoi(argv[3]) : 10;
+
+	// square leaves of random colour with noise
+	uint64 cols = (sx + block - 1) / block;
+	srand(0);
+	PartitionType leaves(sx,sy);
+	ImageType img(ImageType::coord_type(sx,sy));
+	for (uint64 y = 0; y < sy; y++) {
+		for (uint64 x = 0; x < sx; x++) {
+			leaves(x,y)(0) = (y/block)*cols + x/block;
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = rand() % 256;
+		}
+	}
+	const uint64 label_bytes = sx*sy*sizeof(PartitionType::value_data_type);
+	std::cout << "size " << sx << "x" << sy << ", label image " << label_bytes << " bytes" << std::endl;
+
+	uint64 copied = signal_bytes_copied();
+	HierarchyType h;
+	h.init(leaves);
+	std::cout << "init         : " << signal_bytes_copied() - copied << " bytes copied" << std::endl;
+
+	copied = signal_bytes_copied();
+	InputType input(img);
+	LinkDistanceType link_distance;
+	segmentation::DescriptorDistance<HierarchyType, LinkDistanceType> distance(h, link_distance);
+	distance.add_descriptor(VDMeanValue<3>(), input);
+	segmentation::BPTBuilder<HierarchyType, segmentation::DescriptorDistance<HierarchyType, LinkDistanceType> > builder(h, distance);
+	uint64 merges = builder.build();
+	std::cout << "build        : " << signal_bytes_copied() - copied << " bytes copied (" << merges << " merges)" << std::endl;
+
+	copied = signal_bytes_copied();
+	const uint64 calls = 100000;
+	float64 sum = 0;
+	clock_t t = clock();
+	for (uint64 i = 0; i < calls; i++) sum += first_value(img);
+	float64 t_calls = float64(clock() - t) / CLOCKS_PER_SEC;
+	std::cout << "pass by value: " << 1e9*t_calls/calls << " ns per call, " << signal_bytes_copied() - copied << " bytes copied (" << sum << ")" << std::endl;
+	return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * signal_layout_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/image_signal.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef ImageSignal<float32,3>								InterleavedImage;
+typedef ImageSignal<float32,3,AlignedInterleavedLayout<64> >	AlignedImage;
+typedef ImageSignal<float32,3,PlanarLayout<64> >				PlanarImage;
+
+//! Per-channel kernel on the rows of every channel: v = a*v + b
+template<class ImageType>
+void scale_channels(ImageType& img, float32 a, float32 b) {
+	for (uint64 c = 0; c < 3; c++) {
+		typename ImageType::ChannelType ch = img.channel(c);
+		for (uint64 y = 0; y < img.size_y(); y++) {
+			float32* row = &ch(0,y);
+			const int64 step = ch.innerStride();
+			for (uint64 x = 0; x < img.size_x(); x++) row[x*step] = a*row[x*step] + b;
+		}
+	}
+}
+
+//! Throughput of the kernel for a layout
+template<class ImageType>
+void run(uint64 sx, uint64 sy, uint64 repetitions, const char* name) {
+	ImageType img(sx,sy);
+	srand(0);
+	for (uint64 y = 0; y < sy; y++)
+		for (uint64 x = 0; x < sx; x++)
+			for (uint64 c = 0; c < 3; c++) img(x,y)(c) = rand() % 256;
+
+	clock_t t = clock();
+	for (uint64 r = 0; r < repetitions; r++) scale_channels(img, 0.5f, 1.0f);
+	float64 seconds = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	std::cout << name << " : " << float64(sx*sy*repetitions) / 1e6 / seconds << " MPix/s (" << img(sx-1,sy-1)(2) << ")" << std::endl;
+}
+
+//! Throughput of a per-channel kernel on interleaved, aligned interleaved and planar images
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 1999;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 1000;
+	uint64 repetitions = (argc > 3) ? atoi(argv[3]) : 20;
+
+	std::cout << "size " << sx << "x" << sy << std::endl;
+	run<InterleavedImage>(sx, sy, repetitions, "interleaved        ");
+	run<AlignedImage>(sx, sy, repetitions, "aligned interleaved");
+	run<PlanarImage>(sx, sy, repetitions, "planar, aligned    ");
+	return 0;
+}
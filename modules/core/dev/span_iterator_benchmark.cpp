@@ -0,0 +1,63 @@
+/*
+ * span_iterator_benchmark.cpp
+ *
+ *  Created on: Oct 15, 2026
+ *      Author: gpalou
+ */
+
+#include <imageplus/core/signal.hpp>
+#include <imageplus/segmentation/partition/partition.hpp>
+#include <imageplus/segmentation/measures/boundary_recall.hpp>
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+
+using namespace imageplus;
+
+#define uint64 imageplus::uint64
+#define int64 imageplus::int64
+
+typedef segmentation::Partition<uint32,2>	PartitionType;
+
+//! Per-pixel cost of a whole-image pass with the global iterator and with the span iterator
+int main(int argc, char *argv[]) {
+	uint64 sx = (argc > 1) ? atoi(argv[1]) : 4000;
+	uint64 sy = (argc > 2) ? atoi(argv[2]) : 3000;
+	uint64 N = sx*sy;
+
+	PartitionType p(sx,sy), gt(sx,sy);
+	p.set_unique_labels();
+	gt.set_unique_labels();
+
+	// global iterator pass
+	clock_t t = clock();
+	uint64 sum = 0;
+	for (PartitionType::iterator it = p.begin(); it != p.end(); ++it) {
+		sum += (*it)(0);
+	}
+	float64 t_global = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	// span iterator pass
+	t = clock();
+	uint64 sum_span = 0;
+	for (PartitionType::span_iterator s = p.span_begin(); s != p.span_end(); ++s) {
+		const uint32* label = s->data;
+		for (uint64 i = 0; i < s->length; i++) sum_span += *label++;
+	}
+	float64 t_span = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	if (sum != sum_span) {
+		std::cerr << "Span iteration does not visit the same units" << std::endl;
+		return 1;
+	}
+
+	t = clock();
+	float64 recall = segmentation::boundary_recall(p, gt);
+	float64 t_recall = float64(clock() - t) / CLOCKS_PER_SEC;
+
+	std::cout << "size " << sx << "x" << sy << std::endl;
+	std::cout << "global iterator : " << 1e9*t_global/N << " ns/pixel" << std::endl;
+	std::cout << "span iterator   : " << 1e9*t_span/N << " ns/pixel" << std::endl;
+	std::cout << "boundary recall : " << 1e9*t_recall/N << " ns/pixel (" << recall << ")" << std::endl;
+}